@@ -0,0 +1,250 @@
+#ifndef ADAPTIVE_MEASUREMENT_H
+#define ADAPTIVE_MEASUREMENT_H
+
+#include "FlowStatsIndex.h"
+#include "LinkScheduler.h"
+
+#include <functional>
+#include <limits>
+
+// 自适应测量的参数，时间单位为秒
+struct AdaptiveOptions
+{
+    double interval = 0.1;             // 采样周期，每个周期的统计量作为一个批次
+    double minTime = 0.5;              // 每条链路的最短测量时间
+    double maxTime = 5;                // 每条链路的最长测量时间
+    double psrTolerance = 1.0;         // psr 置信区间半宽的上限(百分点)
+    double throughputTolerance = 0.05; // 吞吐率置信区间半宽的上限(相对于均值)
+};
+
+// 95% 双侧置信区间的 t 分布分位数
+double StudentT95(uint32_t df)
+{
+    static const double table[] = {
+        0,     12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179,  2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074,  2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+    };
+    if (df == 0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return df <= 30 ? table[df] : 1.96;
+}
+
+// 批均值法：相邻分组的丢失是相关的，按采样周期分批后再用批均值的方差估计置信区间
+struct BatchMeans
+{
+    uint32_t n = 0;
+    double sum = 0;
+    double sumSq = 0;
+
+    void Add(double x)
+    {
+        n++;
+        sum += x;
+        sumSq += x * x;
+    }
+
+    double Mean() const
+    {
+        return n > 0 ? sum / n : 0;
+    }
+
+    // 样本方差，批次数少于 2 时为 0
+    double Variance() const
+    {
+        return n < 2 ? 0 : std::max(0.0, (sumSq - sum * sum / n) / (n - 1));
+    }
+
+    // 95% 置信区间的半宽，批次数少于 2 时为无穷大
+    double HalfWidth() const
+    {
+        if (n < 2) {
+            return std::numeric_limits<double>::infinity();
+        }
+        return StudentT95(n - 1) * std::sqrt(Variance() / n);
+    }
+};
+
+// 按时隙依次测量链路，每个时隙内的链路同时发送。
+// 每隔 interval 对各条流采样一次，测量时间达到 minTime 之后，时隙内所有链路的
+// psr 和吞吐率置信区间都满足容差时立即停止发送，否则最多测量 maxTime。
+// 停止后经过 gap/2 读取结果，经过 gap 开始下一个时隙，与固定时长测量的时序一致
+class AdaptiveLinkSurvey
+{
+  public:
+    struct Flow
+    {
+        Ptr<Application> app;
+        uint32_t handle;
+    };
+    // 在当前时刻创建并启动一条 source -> sink 的流
+    typedef std::function<Flow(uint16_t, uint16_t)> FlowFactory;
+    // 快进模式下控制干扰节点：openWindow(delay) 表示 delay 秒后开始一个时隙，closeWindow() 在读取时隙结果后调用
+    typedef std::function<void(double)> WindowOpener;
+    typedef std::function<void()> WindowCloser;
+
+    AdaptiveLinkSurvey(const AdaptiveOptions &options,
+                       FlowStatsIndex *flowIndex,
+                       Matrix<double> *throughput,
+                       Matrix<double> *psr,
+                       Matrix<double> *throughputHalfWidth,
+                       Matrix<double> *psrHalfWidth,
+                       Matrix<double> *duration,
+                       double gap)
+        : m_options(options),
+          m_flowIndex(flowIndex),
+          m_throughput(throughput),
+          m_psr(psr),
+          m_throughputHalfWidth(throughputHalfWidth),
+          m_psrHalfWidth(psrHalfWidth),
+          m_duration(duration),
+          m_gap(gap)
+    {
+    }
+
+    void AddWindow(const std::vector<Link> &links)
+    {
+        m_windows.push_back(links);
+    }
+
+    uint32_t GetNWindows() const
+    {
+        return m_windows.size();
+    }
+
+    // 时隙的开始时刻在仿真过程中才确定，由 survey 在每个时隙开始之前通知打开干扰节点
+    void SetWindowGate(WindowOpener openWindow, WindowCloser closeWindow)
+    {
+        m_openWindow = openWindow;
+        m_closeWindow = closeWindow;
+    }
+
+    // 从 startTime 开始依次测量所有时隙，最后一个时隙结束后停止仿真
+    void Start(double startTime, FlowFactory createFlow)
+    {
+        m_createFlow = createFlow;
+        m_next = 0;
+        if (m_windows.empty()) {
+            Simulator::Stop(Seconds(startTime));
+            return;
+        }
+        Simulator::Schedule(Seconds(startTime), &AdaptiveLinkSurvey::StartWindow, this);
+        if (m_openWindow) {
+            m_openWindow(startTime);
+        }
+    }
+
+  private:
+    struct ActiveFlow
+    {
+        Link link;
+        Flow flow;
+        bool warm = false; // 第一个批次包含ARP等启动过程，不计入统计
+        BatchMeans throughput;
+        BatchMeans psr;
+    };
+
+    void StartWindow()
+    {
+        m_active.clear();
+        m_windowStart = Simulator::Now();
+        for (const auto &link : m_windows[m_next]) {
+            ActiveFlow active;
+            active.link = link;
+            active.flow = m_createFlow(link.first, link.second);
+            m_active.push_back(active);
+        }
+        m_next++;
+        Simulator::Schedule(Seconds(m_options.interval), &AdaptiveLinkSurvey::Sample, this);
+    }
+
+    void Sample()
+    {
+        bool converged = true;
+        for (auto &active : m_active) {
+            FlowSample sample = m_flowIndex->Sample(active.flow.handle);
+            if (sample.txPackets > 0) {
+                if (active.warm) {
+                    active.psr.Add(sample.rxPackets * 100.0 / sample.txPackets);
+                    active.throughput.Add(sample.rxBytes * 8.0 / m_options.interval / 1024 / 1024);
+                }
+                active.warm = true;
+            }
+            converged = converged && active.psr.HalfWidth() <= m_options.psrTolerance &&
+                        active.throughput.HalfWidth() <=
+                            m_options.throughputTolerance * active.throughput.Mean();
+        }
+        // 留出半个采样周期的余量，避免浮点误差多采样一次
+        double elapsed = (Simulator::Now() - m_windowStart).GetSeconds() + m_options.interval / 2;
+        if ((converged && elapsed >= m_options.minTime) || elapsed >= m_options.maxTime) {
+            StopWindow();
+        } else {
+            Simulator::Schedule(Seconds(m_options.interval), &AdaptiveLinkSurvey::Sample, this);
+        }
+    }
+
+    void StopWindow()
+    {
+        // Application::SetStopTime 在启动后设置不再生效。先关闭套接字的发送方向，已经调度的下一次发送
+        // 失败而不产生分组；OnOffApplication 随后发现已达到 MaxBytes，停止调度发送
+        for (auto &active : m_active) {
+            Ptr<Socket> socket = DynamicCast<OnOffApplication>(active.flow.app)->GetSocket();
+            if (socket) {
+                socket->ShutdownSend();
+            }
+            active.flow.app->SetAttribute("MaxBytes", UintegerValue(1));
+        }
+        m_windowDuration = (Simulator::Now() - m_windowStart).GetSeconds();
+        Simulator::Schedule(Seconds(m_gap / 2), &AdaptiveLinkSurvey::Collect, this);
+        if (m_next < m_windows.size()) {
+            Simulator::Schedule(Seconds(m_gap), &AdaptiveLinkSurvey::StartWindow, this);
+            if (m_openWindow) {
+                m_openWindow(m_gap);
+            }
+        } else {
+            Simulator::Stop(Seconds(m_gap));
+        }
+    }
+
+    // 与固定时长测量相同，结果为整条流从第一个分组发送到最后一个分组接收的吞吐率和psr
+    void Collect()
+    {
+        for (auto &active : m_active) {
+            FlowSample sample = m_flowIndex->Cumulative(active.flow.handle);
+            uint16_t i = active.link.first;
+            uint16_t j = active.link.second;
+            (*m_throughput)[i][j] = sample.valid ? sample.throughput : 0.0;
+            (*m_psr)[i][j] = sample.valid ? sample.psr : 0.0;
+            // 批次不足无法估计置信区间时记为 -1
+            double throughputHalfWidth = active.throughput.HalfWidth();
+            double psrHalfWidth = active.psr.HalfWidth();
+            (*m_throughputHalfWidth)[i][j] = std::isinf(throughputHalfWidth) ? -1 : throughputHalfWidth;
+            (*m_psrHalfWidth)[i][j] = std::isinf(psrHalfWidth) ? -1 : psrHalfWidth;
+            (*m_duration)[i][j] = m_windowDuration;
+        }
+        if (m_closeWindow) {
+            m_closeWindow();
+        }
+    }
+
+    AdaptiveOptions m_options;
+    FlowStatsIndex *m_flowIndex;
+    Matrix<double> *m_throughput;
+    Matrix<double> *m_psr;
+    Matrix<double> *m_throughputHalfWidth;
+    Matrix<double> *m_psrHalfWidth;
+    Matrix<double> *m_duration;
+    double m_gap;
+
+    FlowFactory m_createFlow;
+    WindowOpener m_openWindow;
+    WindowCloser m_closeWindow;
+    std::vector<std::vector<Link>> m_windows;
+    size_t m_next = 0;
+    std::vector<ActiveFlow> m_active;
+    Time m_windowStart;
+    double m_windowDuration = 0;
+};
+
+#endif // ADAPTIVE_MEASUREMENT_H
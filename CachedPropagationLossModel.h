@@ -0,0 +1,145 @@
+#ifndef CACHED_PROPAGATION_LOSS_MODEL_H
+#define CACHED_PROPAGATION_LOSS_MODEL_H
+
+#include "ns3/mobility-model.h"
+#include "ns3/node-container.h"
+#include "ns3/propagation-loss-model.h"
+
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+// 带缓存的传播损耗模型：包装任意一个内部损耗模型，在节点位置确定后一次性计算
+// 所有节点之间的增益矩阵，之后每次传输只查表。节点位置变化(CourseChange)时
+// 只失效该节点所在的行和列，下次用到时重新计算。
+// 要求内部模型的损耗与发射功率无关(Friis、LogDistance 等确定性模型都满足)。
+class CachedPropagationLossModel : public PropagationLossModel
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid = TypeId("ns3::CachedPropagationLossModel")
+                                .SetParent<PropagationLossModel>()
+                                .SetGroupName("Propagation")
+                                .AddConstructor<CachedPropagationLossModel>();
+        return tid;
+    }
+
+    void SetInnerModel(Ptr<PropagationLossModel> inner)
+    {
+        m_inner = inner;
+        Clear();
+    }
+
+    Ptr<PropagationLossModel> GetInnerModel() const
+    {
+        return m_inner;
+    }
+
+    // 为给定节点建立索引并计算完整的增益矩阵，需要在安装移动模型之后调用
+    void Precompute(const NodeContainer &nodes)
+    {
+        Clear();
+        m_n = nodes.GetN();
+        m_mobility.resize(m_n);
+        for (uint32_t i = 0; i < m_n; ++i) {
+            Ptr<MobilityModel> mobility = nodes.Get(i)->GetObject<MobilityModel>();
+            NS_ASSERT_MSG(mobility, "Node " << i << " has no mobility model");
+            m_mobility[i] = mobility;
+            m_index[PeekPointer(mobility)] = i;
+            mobility->TraceConnectWithoutContext(
+                "CourseChange",
+                MakeCallback(&CachedPropagationLossModel::CourseChanged, this));
+        }
+        m_gainDb.assign(size_t(m_n) * m_n, std::numeric_limits<double>::quiet_NaN());
+        for (uint32_t i = 0; i < m_n; ++i) {
+            for (uint32_t j = 0; j < m_n; ++j) {
+                if (i != j) {
+                    m_gainDb[size_t(i) * m_n + j] = m_inner->CalcRxPower(0, m_mobility[i], m_mobility[j]);
+                }
+            }
+        }
+    }
+
+    uint64_t GetHits() const
+    {
+        return m_hits;
+    }
+
+    uint64_t GetMisses() const
+    {
+        return m_misses;
+    }
+
+    uint64_t GetInvalidations() const
+    {
+        return m_invalidations;
+    }
+
+  private:
+    double DoCalcRxPower(double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const override
+    {
+        auto ia = m_index.find(PeekPointer(a));
+        auto ib = m_index.find(PeekPointer(b));
+        if (ia == m_index.end() || ib == m_index.end()) {
+            // 不在缓存范围内的节点，直接交给内部模型计算
+            m_misses++;
+            return m_inner->CalcRxPower(txPowerDbm, a, b);
+        }
+        double &gainDb = m_gainDb[size_t(ia->second) * m_n + ib->second];
+        if (std::isnan(gainDb)) {
+            m_misses++;
+            gainDb = m_inner->CalcRxPower(0, a, b);
+        } else {
+            m_hits++;
+        }
+        return txPowerDbm + gainDb;
+    }
+
+    int64_t DoAssignStreams(int64_t stream) override
+    {
+        return m_inner ? m_inner->AssignStreams(stream) : 0;
+    }
+
+    // 节点移动后失效其所在的行和列
+    void CourseChanged(Ptr<const MobilityModel> mobility)
+    {
+        auto it = m_index.find(PeekPointer(mobility));
+        if (it == m_index.end()) {
+            return;
+        }
+        uint32_t i = it->second;
+        for (uint32_t j = 0; j < m_n; ++j) {
+            m_gainDb[size_t(i) * m_n + j] = std::numeric_limits<double>::quiet_NaN();
+            m_gainDb[size_t(j) * m_n + i] = std::numeric_limits<double>::quiet_NaN();
+        }
+        m_invalidations++;
+    }
+
+    void Clear()
+    {
+        m_n = 0;
+        m_index.clear();
+        m_mobility.clear();
+        m_gainDb.clear();
+    }
+
+    Ptr<PropagationLossModel> m_inner;
+    uint32_t m_n = 0;
+    std::unordered_map<const MobilityModel *, uint32_t> m_index; // 移动模型 -> 矩阵下标
+    std::vector<Ptr<MobilityModel>> m_mobility;
+    mutable std::vector<double> m_gainDb; // 按行优先存放的增益矩阵(dB)，NaN 表示需要重新计算
+    mutable uint64_t m_hits = 0;
+    mutable uint64_t m_misses = 0;
+    uint64_t m_invalidations = 0;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(CachedPropagationLossModel);
+
+} // namespace ns3
+
+#endif // CACHED_PROPAGATION_LOSS_MODEL_H
@@ -0,0 +1,96 @@
+#ifndef FLOW_COUNTER_PROBE_H
+#define FLOW_COUNTER_PROBE_H
+
+#include "UtilityFunctions.h"
+
+#include <unordered_map>
+
+// 一条流的累计统计量，由 FlowMonitor 或 FlowCounterProbe 提供
+struct FlowCounters
+{
+    uint64_t txPackets = 0;
+    uint64_t rxPackets = 0;
+    uint64_t rxBytes = 0;
+    Time timeFirstTxPacket;
+    Time timeLastRxPacket;
+    Time delaySum; // 计数探针不测量时延，始终为零
+};
+
+// 轻量的流计数探针：只在 OnOff 应用的 Tx 和 PacketSink 的 RxWithAddresses 上挂接回调，
+// 每条流只有一组定长计数器，处理分组时不分配内存，可以代替 FlowMonitor::InstallAll。
+// 接收端按 (源地址, 目的地址) 把分组计入该节点对上最近开始发送的流，
+// 同一节点对上的流不会同时运行(测量时隙之间有间隔)。
+// 字节数加上 IPv4 和 UDP 头，与 FlowMonitor 在 IP 层统计的结果一致
+class FlowCounterProbe
+{
+  public:
+    static const uint32_t kHeaderBytes = 28; // IPv4(20) + UDP(8)
+
+    // 登记一条流，handle 与 FlowStatsIndex 中的句柄相同
+    void AddFlow(uint32_t handle, Ptr<Application> source, Ipv4Address sourceAddress, Ipv4Address sinkAddress)
+    {
+        if (handle >= m_flows.size()) {
+            m_flows.resize(handle + 1);
+        }
+        source->TraceConnectWithoutContext("Tx", MakeBoundCallback(&FlowCounterProbe::TxTrace, this, handle,
+                                                                   MakeKey(sourceAddress, sinkAddress)));
+    }
+
+    // 在所有接收应用上挂接回调，接收地址为所在节点 Wi-Fi 接口的地址
+    void AddSinks(const ApplicationContainer &sinks)
+    {
+        for (uint32_t i = 0; i < sinks.GetN(); ++i) {
+            Ptr<Application> sink = sinks.Get(i);
+            Ipv4Address address = sink->GetNode()->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal();
+            sink->TraceConnectWithoutContext("RxWithAddresses",
+                MakeBoundCallback(&FlowCounterProbe::RxTrace, this, address));
+        }
+    }
+
+    // 该流已经发送过分组时返回 true
+    bool Get(uint32_t handle, FlowCounters *counters) const
+    {
+        if (handle >= m_flows.size() || m_flows[handle].txPackets == 0) {
+            return false;
+        }
+        *counters = m_flows[handle];
+        return true;
+    }
+
+  private:
+    static uint64_t MakeKey(Ipv4Address sourceAddress, Ipv4Address sinkAddress)
+    {
+        return (uint64_t(sourceAddress.Get()) << 32) | sinkAddress.Get();
+    }
+
+    static void TxTrace(FlowCounterProbe *probe, uint32_t handle, uint64_t key, Ptr<const Packet> packet)
+    {
+        FlowCounters &flow = probe->m_flows[handle];
+        if (flow.txPackets == 0) {
+            flow.timeFirstTxPacket = Simulator::Now();
+            probe->m_current[key] = handle;
+        }
+        flow.txPackets++;
+    }
+
+    static void RxTrace(FlowCounterProbe *probe, Ipv4Address sinkAddress, Ptr<const Packet> packet,
+                        const Address &from, const Address &to)
+    {
+        if (!InetSocketAddress::IsMatchingType(from)) {
+            return;
+        }
+        auto it = probe->m_current.find(MakeKey(InetSocketAddress::ConvertFrom(from).GetIpv4(), sinkAddress));
+        if (it == probe->m_current.end()) {
+            return;
+        }
+        FlowCounters &flow = probe->m_flows[it->second];
+        flow.rxPackets++;
+        flow.rxBytes += packet->GetSize() + kHeaderBytes;
+        flow.timeLastRxPacket = Simulator::Now();
+    }
+
+    std::vector<FlowCounters> m_flows;
+    std::unordered_map<uint64_t, uint32_t> m_current; // 每个节点对上正在发送的流
+};
+
+#endif // FLOW_COUNTER_PROBE_H
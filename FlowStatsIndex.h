@@ -0,0 +1,185 @@
+#ifndef FLOW_STATS_INDEX_H
+#define FLOW_STATS_INDEX_H
+
+#include "FlowCounterProbe.h"
+
+#include <deque>
+#include <unordered_map>
+
+// 单次采样的结果，吞吐率单位为 Mbps，psr 为百分数
+struct FlowSample
+{
+    bool valid = false;      // 是否已经找到对应的流并且时间间隔大于零
+    FlowId flowId = 0;
+    double throughput = 0.0;
+    double psr = 0.0;
+    double interval = 0.0;   // 本次采样覆盖的时间长度(秒)
+    uint64_t txPackets = 0;  // 本次采样窗口内发送的分组数
+    uint64_t rxPackets = 0;  // 本次采样窗口内接收的分组数
+    uint64_t rxBytes = 0;    // 本次采样窗口内接收的字节数
+    double delay = 0.0;      // 平均端到端时延(秒)，只由 Cumulative 计算
+};
+
+// 流索引：在 createDataFlow 中按 (源地址, 目的地址, 目的端口) 登记每条流，
+// 第一次采样时把它解析为 FlowMonitor 的 FlowId，之后只读取该流的统计量。
+// 吞吐率和 psr 都按照与上一次采样的差值计算，单次采样的开销与之前的流数量无关。
+// 使用计数探针时不安装 FlowMonitor，统计量直接按句柄从探针读取
+class FlowStatsIndex
+{
+  public:
+    FlowStatsIndex(Ptr<FlowMonitor> monitor, Ptr<Ipv4FlowClassifier> classifier, FlowCounterProbe *probe = nullptr)
+        : m_monitor(monitor),
+          m_classifier(classifier),
+          m_probe(probe)
+    {
+    }
+
+    // 登记一条流，返回用于采样的句柄；使用计数探针时需要提供发送该流的应用
+    uint32_t Register(Ipv4Address sourceAddress, Ipv4Address sinkAddress, uint16_t port,
+                      Ptr<Application> source = nullptr)
+    {
+        uint32_t handle = m_entries.size();
+        m_entries.emplace_back();
+        if (m_probe) {
+            NS_ABORT_MSG_IF(!source, "计数探针需要登记流的发送应用");
+            m_probe->AddFlow(handle, source, sourceAddress, sinkAddress);
+        } else {
+            m_pending[MakeKey(sourceAddress, sinkAddress, port)].push_back(handle);
+        }
+        return handle;
+    }
+
+    // 读取该流的累计统计量，还没有任何分组经过时返回 false
+    bool GetCounters(uint32_t handle, FlowCounters *counters, FlowId *flowId = nullptr)
+    {
+        if (m_probe) {
+            if (flowId) {
+                *flowId = handle + 1; // 探针模式下没有 FlowId，用非零的编号代替
+            }
+            return m_probe->Get(handle, counters);
+        }
+        Entry &entry = m_entries.at(handle);
+        if (!entry.resolved) {
+            ResolveNewFlows();
+        }
+        if (!entry.resolved) {
+            return false;
+        }
+        const FlowMonitor::FlowStatsContainer &stats = m_monitor->GetFlowStats();
+        auto it = stats.find(entry.flowId);
+        if (it == stats.end()) {
+            return false;
+        }
+        const FlowMonitor::FlowStats &fs = it->second;
+        counters->txPackets = fs.txPackets;
+        counters->rxPackets = fs.rxPackets;
+        counters->rxBytes = fs.rxBytes;
+        counters->timeFirstTxPacket = fs.timeFirstTxPacket;
+        counters->timeLastRxPacket = fs.timeLastRxPacket;
+        counters->delaySum = fs.delaySum;
+        if (flowId) {
+            *flowId = entry.flowId;
+        }
+        return true;
+    }
+
+    // 计算自上次采样以来该流的吞吐率和psr
+    FlowSample Sample(uint32_t handle)
+    {
+        FlowSample sample;
+        FlowCounters fs;
+        FlowId flowId = 0;
+        if (!GetCounters(handle, &fs, &flowId)) {
+            return sample; // 该流还没有任何分组经过
+        }
+        Entry &entry = m_entries[handle];
+        if (entry.windowStart.IsNegative()) {
+            entry.windowStart = fs.timeFirstTxPacket;
+        }
+        sample.flowId = flowId;
+        sample.txPackets = fs.txPackets - entry.txPackets;
+        sample.rxPackets = fs.rxPackets - entry.rxPackets;
+        sample.rxBytes = fs.rxBytes - entry.rxBytes;
+        sample.interval = (fs.timeLastRxPacket - entry.windowStart).GetSeconds();
+        if (sample.interval > 0 && sample.txPackets > 0) {
+            sample.valid = true;
+            sample.throughput = sample.rxBytes * 8.0 / sample.interval / 1024 / 1024;
+            sample.psr = sample.rxPackets * 100.0 / sample.txPackets;
+            entry.windowStart = fs.timeLastRxPacket;
+        }
+        entry.txPackets = fs.txPackets;
+        entry.rxPackets = fs.rxPackets;
+        entry.rxBytes = fs.rxBytes;
+        return sample;
+    }
+
+    // 从该流第一个分组发送到最后一个分组接收的整体吞吐率和psr，不影响增量采样
+    FlowSample Cumulative(uint32_t handle)
+    {
+        FlowSample sample;
+        FlowCounters fs;
+        FlowId flowId = 0;
+        if (!GetCounters(handle, &fs, &flowId)) {
+            return sample;
+        }
+        sample.flowId = flowId;
+        sample.txPackets = fs.txPackets;
+        sample.rxPackets = fs.rxPackets;
+        sample.rxBytes = fs.rxBytes;
+        sample.delay = fs.rxPackets > 0 ? fs.delaySum.GetSeconds() / fs.rxPackets : 0.0;
+        sample.interval = (fs.timeLastRxPacket - fs.timeFirstTxPacket).GetSeconds();
+        if (sample.interval > 0 && sample.txPackets > 0) {
+            sample.valid = true;
+            sample.throughput = fs.rxBytes * 8.0 / sample.interval / 1024 / 1024;
+            sample.psr = sample.rxPackets * 100.0 / sample.txPackets;
+        }
+        return sample;
+    }
+
+  private:
+    struct Entry
+    {
+        bool resolved = false;
+        FlowId flowId = 0;
+        uint64_t txPackets = 0;
+        uint64_t rxPackets = 0;
+        uint64_t rxBytes = 0;
+        Time windowStart = Seconds(-1);
+    };
+
+    static uint64_t MakeKey(Ipv4Address sourceAddress, Ipv4Address sinkAddress, uint16_t port)
+    {
+        // 同一网段内地址的主机部分不超过 24 位
+        return (uint64_t(sourceAddress.Get() & 0xffffff) << 40) |
+               (uint64_t(sinkAddress.Get() & 0xffffff) << 16) | port;
+    }
+
+    // 只检查上次解析之后新出现的 FlowId，每条流只解析一次。
+    // 同一个键上登记了多条流时，按照登记顺序依次对应
+    void ResolveNewFlows()
+    {
+        const FlowMonitor::FlowStatsContainer &stats = m_monitor->GetFlowStats();
+        for (auto it = stats.upper_bound(m_scanned); it != stats.end(); ++it) {
+            m_scanned = it->first;
+            Ipv4FlowClassifier::FiveTuple t = m_classifier->FindFlow(it->first);
+            auto pending = m_pending.find(MakeKey(t.sourceAddress, t.destinationAddress,
+                                                  t.destinationPort));
+            if (pending == m_pending.end() || pending->second.empty()) {
+                continue; // 不是通过 Register 登记的流
+            }
+            Entry &entry = m_entries[pending->second.front()];
+            pending->second.pop_front();
+            entry.resolved = true;
+            entry.flowId = it->first;
+        }
+    }
+
+    Ptr<FlowMonitor> m_monitor;
+    Ptr<Ipv4FlowClassifier> m_classifier;
+    FlowCounterProbe *m_probe;
+    std::vector<Entry> m_entries;
+    std::unordered_map<uint64_t, std::deque<uint32_t>> m_pending;
+    FlowId m_scanned = 0;
+};
+
+#endif // FLOW_STATS_INDEX_H
@@ -0,0 +1,312 @@
+#ifndef GRID_SPECTRUM_CHANNEL_H
+#define GRID_SPECTRUM_CHANNEL_H
+
+#include "ns3/angles.h"
+#include "ns3/antenna-model.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/simulator.h"
+#include "ns3/spectrum-channel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace ns3
+{
+
+// 按空间网格索引接收机的频谱信道：与 SingleModelSpectrumChannel 一样不转换功率谱密度，
+// 但每次发送只检查发送者周围可能收到不低于 cutoff 功率的网格中的接收机，
+// 其余接收机直接跳过，发送的开销与局部节点密度有关而与节点总数无关。
+// 可达距离按发射功率由传播损耗模型反解，要求损耗随距离单调增加(Friis、LogDistance 等)且天线为全向天线。
+// 接收机的网格在第一次发送时建立(此时节点位置已经确定)，节点移动或增删接收机后重建。
+// 不支持频谱相关的传播损耗模型。与 SingleModelSpectrumChannel 一样要求所有发送者使用同一个频谱模型，
+// 出现其他频谱模型时终止仿真
+class GridSpectrumChannel : public SpectrumChannel
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid = TypeId("ns3::GridSpectrumChannel")
+                                .SetParent<SpectrumChannel>()
+                                .SetGroupName("Spectrum")
+                                .AddConstructor<GridSpectrumChannel>();
+        return tid;
+    }
+
+    // 接收功率低于该值(dBm)的传输不投递
+    void SetCutoff(double cutoffDbm)
+    {
+        m_cutoffDbm = cutoffDbm;
+        m_ranges.clear();
+    }
+
+    // 网格的边长(米)
+    void SetCellSize(double cellSize)
+    {
+        m_cellSize = cellSize;
+        m_dirty = true;
+    }
+
+    uint64_t GetTransmissions() const
+    {
+        return m_transmissions;
+    }
+
+    // 实际投递给接收机的次数
+    uint64_t GetDeliveries() const
+    {
+        return m_deliveries;
+    }
+
+    // 因为超出可达距离或接收功率低于 cutoff 而没有投递的次数
+    uint64_t GetCulled() const
+    {
+        return m_culled;
+    }
+
+    void AddRx(Ptr<SpectrumPhy> phy) override
+    {
+        m_phyList.push_back(phy);
+        m_dirty = true;
+    }
+
+    void RemoveRx(Ptr<SpectrumPhy> phy) override
+    {
+        m_phyList.erase(std::remove(m_phyList.begin(), m_phyList.end(), phy), m_phyList.end());
+        m_dirty = true;
+    }
+
+    std::size_t GetNDevices() const override
+    {
+        return m_phyList.size();
+    }
+
+    Ptr<NetDevice> GetDevice(std::size_t i) const override
+    {
+        return m_phyList.at(i)->GetDevice();
+    }
+
+    void StartTx(Ptr<SpectrumSignalParameters> txParams) override
+    {
+        NS_ASSERT_MSG(txParams->psd, "NULL txPsd");
+        NS_ASSERT_MSG(txParams->txPhy, "NULL txPhy");
+        NS_ABORT_MSG_IF(m_spectrumPropagationLoss, "GridSpectrumChannel 不支持频谱相关的传播损耗模型");
+        // 优化编译时 NS_ASSERT 不生效，这里用 NS_ABORT，避免把另一个频谱模型的功率谱密度交给接收机
+        SpectrumModelUid_t modelUid = txParams->psd->GetSpectrumModelUid();
+        if (!m_hasSpectrumModel) {
+            m_spectrumModelUid = modelUid;
+            m_hasSpectrumModel = true;
+        }
+        NS_ABORT_MSG_IF(modelUid != m_spectrumModelUid,
+                        "GridSpectrumChannel 只支持一个频谱模型，收到频谱模型 " << modelUid << "，信道使用 "
+                                                                        << m_spectrumModelUid);
+        m_txSigParamsTrace(txParams->Copy());
+        m_transmissions++;
+        if (m_dirty) {
+            BuildGrid();
+        }
+
+        double txPowerDbm = 10 * std::log10(Integral(*txParams->psd)) + 30;
+        Ptr<MobilityModel> senderMobility = txParams->txPhy->GetMobility();
+        if (!senderMobility) { // 发送者没有位置，只能投递给所有接收机
+            for (uint32_t k = 0; k < m_phyList.size(); ++k) {
+                Deliver(txParams, txPowerDbm, nullptr, k);
+            }
+            return;
+        }
+        for (uint32_t k : m_unindexed) {
+            Deliver(txParams, txPowerDbm, senderMobility, k);
+        }
+        double range = GetRange(txPowerDbm);
+        Vector position = senderMobility->GetPosition();
+        int32_t x0 = CellX(position.x - range);
+        int32_t x1 = CellX(position.x + range);
+        int32_t y0 = CellY(position.y - range);
+        int32_t y1 = CellY(position.y + range);
+        uint64_t considered = 0;
+        for (int32_t y = y0; y <= y1; ++y) {
+            for (int32_t x = x0; x <= x1; ++x) {
+                for (uint32_t k : m_cells[size_t(y) * m_cols + x]) {
+                    if (CalculateDistance(position, m_positions[k]) > range) {
+                        continue;
+                    }
+                    considered++;
+                    Deliver(txParams, txPowerDbm, senderMobility, k);
+                }
+            }
+        }
+        m_culled += m_indexedCount - considered; // 发送者自己也在网格中时会被计为已检查
+    }
+
+  private:
+    static void StartRx(Ptr<SpectrumPhy> rxPhy, Ptr<SpectrumSignalParameters> params)
+    {
+        rxPhy->StartRx(params);
+    }
+
+    // 与 SingleModelSpectrumChannel 相同的损耗和时延计算，接收功率低于 cutoff 时不投递
+    void Deliver(Ptr<SpectrumSignalParameters> txParams, double txPowerDbm, Ptr<MobilityModel> senderMobility,
+                 uint32_t k)
+    {
+        Ptr<SpectrumPhy> rxPhy = m_phyList[k];
+        if (rxPhy == txParams->txPhy) {
+            return;
+        }
+        Ptr<MobilityModel> receiverMobility = rxPhy->GetMobility();
+        Ptr<SpectrumSignalParameters> rxParams = txParams->Copy();
+        Time delay = MicroSeconds(0);
+        if (senderMobility && receiverMobility) {
+            if (m_propagationDelay) {
+                delay = m_propagationDelay->GetDelay(senderMobility, receiverMobility);
+            }
+            double pathLossDb = 0;
+            if (rxParams->txAntenna) {
+                Angles txAngles(receiverMobility->GetPosition(), senderMobility->GetPosition());
+                pathLossDb -= rxParams->txAntenna->GetGainDb(txAngles);
+            }
+            Ptr<AntennaModel> rxAntenna = DynamicCast<AntennaModel>(rxPhy->GetAntenna());
+            if (rxAntenna) {
+                Angles rxAngles(senderMobility->GetPosition(), receiverMobility->GetPosition());
+                pathLossDb -= rxAntenna->GetGainDb(rxAngles);
+            }
+            if (m_propagationLoss) {
+                pathLossDb -= m_propagationLoss->CalcRxPower(0, senderMobility, receiverMobility);
+            }
+            m_pathLossTrace(txParams->txPhy, rxPhy, pathLossDb);
+            if (pathLossDb > m_maxLossDb || txPowerDbm - pathLossDb < m_cutoffDbm) {
+                m_culled++;
+                return;
+            }
+            *(rxParams->psd) *= std::pow(10.0, -pathLossDb / 10.0);
+        }
+        m_deliveries++;
+        Ptr<NetDevice> device = rxPhy->GetDevice();
+        if (device && device->GetNode()) {
+            Simulator::ScheduleWithContext(device->GetNode()->GetId(), delay, &GridSpectrumChannel::StartRx,
+                                           rxPhy, rxParams);
+        } else {
+            Simulator::Schedule(delay, &GridSpectrumChannel::StartRx, rxPhy, rxParams);
+        }
+    }
+
+    // 接收功率不低于 cutoff 的最远距离，按 0.1 dB 向上取整的发射功率缓存
+    double GetRange(double txPowerDbm)
+    {
+        int64_t key = int64_t(std::ceil(txPowerDbm * 10));
+        auto it = m_ranges.find(key);
+        if (it != m_ranges.end()) {
+            return it->second;
+        }
+        double power = key / 10.0;
+        double range = std::numeric_limits<double>::infinity();
+        if (m_propagationLoss) {
+            Ptr<ConstantPositionMobilityModel> a = CreateObject<ConstantPositionMobilityModel>();
+            Ptr<ConstantPositionMobilityModel> b = CreateObject<ConstantPositionMobilityModel>();
+            a->SetPosition(Vector(0, 0, 0));
+            auto reaches = [&](double distance) {
+                b->SetPosition(Vector(distance, 0, 0));
+                return m_propagationLoss->CalcRxPower(power, a, b) >= m_cutoffDbm;
+            };
+            const double maxRange = 1e6;
+            if (!reaches(maxRange)) {
+                double low = 0;
+                double high = maxRange;
+                while (high - low > 0.01) { // 二分查找，结果偏大不影响正确性
+                    double middle = (low + high) / 2;
+                    (reaches(middle) ? low : high) = middle;
+                }
+                range = high;
+            }
+        }
+        m_ranges[key] = range;
+        return range;
+    }
+
+    // 坐标所在的网格列/行，超出范围(包括可达距离为无穷大)时取边界
+    int32_t CellX(double x) const
+    {
+        return int32_t(std::max(0.0, std::min(double(m_cols) - 1, std::floor((x - m_minX) / m_cellSize))));
+    }
+
+    int32_t CellY(double y) const
+    {
+        return int32_t(std::max(0.0, std::min(double(m_rows) - 1, std::floor((y - m_minY) / m_cellSize))));
+    }
+
+    void BuildGrid()
+    {
+        m_dirty = false;
+        m_unindexed.clear();
+        m_cells.clear();
+        m_positions.assign(m_phyList.size(), Vector());
+        m_indexedCount = 0;
+        double maxX = 0;
+        double maxY = 0;
+        bool first = true;
+        for (uint32_t k = 0; k < m_phyList.size(); ++k) {
+            Ptr<MobilityModel> mobility = m_phyList[k]->GetMobility();
+            if (!mobility) {
+                m_unindexed.push_back(k);
+                continue;
+            }
+            if (m_watched.insert(PeekPointer(mobility)).second) {
+                mobility->TraceConnectWithoutContext("CourseChange",
+                    MakeCallback(&GridSpectrumChannel::CourseChanged, this));
+            }
+            Vector position = mobility->GetPosition();
+            m_positions[k] = position;
+            m_minX = first ? position.x : std::min(m_minX, position.x);
+            m_minY = first ? position.y : std::min(m_minY, position.y);
+            maxX = first ? position.x : std::max(maxX, position.x);
+            maxY = first ? position.y : std::max(maxY, position.y);
+            first = false;
+        }
+        m_cols = uint32_t((maxX - m_minX) / m_cellSize) + 1;
+        m_rows = uint32_t((maxY - m_minY) / m_cellSize) + 1;
+        m_cells.assign(size_t(m_cols) * m_rows, std::vector<uint32_t>());
+        for (uint32_t k = 0; k < m_phyList.size(); ++k) {
+            if (m_phyList[k]->GetMobility()) {
+                m_cells[size_t(CellY(m_positions[k].y)) * m_cols + CellX(m_positions[k].x)].push_back(k);
+                m_indexedCount++;
+            }
+        }
+    }
+
+    void CourseChanged(Ptr<const MobilityModel> mobility)
+    {
+        m_dirty = true;
+    }
+
+    std::vector<Ptr<SpectrumPhy>> m_phyList;
+    bool m_hasSpectrumModel = false; // 第一次发送时记录信道使用的频谱模型
+    SpectrumModelUid_t m_spectrumModelUid = 0;
+    double m_cutoffDbm = -110;
+    double m_cellSize = 50;
+    bool m_dirty = true;
+    std::map<int64_t, double> m_ranges; // 发射功率(0.1 dBm) -> 可达距离
+    std::vector<Vector> m_positions;
+    std::vector<std::vector<uint32_t>> m_cells; // 按行优先存放的网格，每个网格中接收机的下标
+    std::vector<uint32_t> m_unindexed; // 没有位置的接收机，每次都投递
+    std::set<const MobilityModel *> m_watched;
+    uint64_t m_indexedCount = 0;
+    double m_minX = 0;
+    double m_minY = 0;
+    uint32_t m_cols = 0;
+    uint32_t m_rows = 0;
+    uint64_t m_transmissions = 0;
+    uint64_t m_deliveries = 0;
+    uint64_t m_culled = 0;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(GridSpectrumChannel);
+
+} // namespace ns3
+
+#endif // GRID_SPECTRUM_CHANNEL_H
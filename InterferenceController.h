@@ -0,0 +1,170 @@
+#ifndef INTERFERENCE_CONTROLLER_H
+#define INTERFERENCE_CONTROLLER_H
+
+#include "UtilityFunctions.h"
+
+// 干扰节点的两种实现方式
+enum InterferenceMode
+{
+    INTERFERENCE_WAVEFORM, // 每个干扰节点是一个 WaveformGenerator，逐个波形在频谱信道上传输
+    INTERFERENCE_PSD,      // 把干扰的接收功率折算到每个 Wi-Fi PHY 的噪声中，不产生任何传输事件
+};
+
+InterferenceMode ParseInterferenceMode(const std::string &mode)
+{
+    if (mode == "waveform") {
+        return INTERFERENCE_WAVEFORM;
+    }
+    if (mode == "psd") {
+        return INTERFERENCE_PSD;
+    }
+    throw std::runtime_error("Unknown interference mode " + mode + " (expected waveform or psd)");
+}
+
+// 统一控制干扰节点的启停。
+// PSD 模式下，干扰节点 k 在 Wi-Fi 节点 r 处的带内接收功率为 waveformPower * gain(k, r)，
+// 与热噪声 Nt = kTB 相加后换算为等效噪声系数 NF' = NF + I/Nt 写入 PHY，
+// 只有干扰节点的开关状态改变时才重新计算。该模式不模拟干扰对 CCA 的影响，
+// 干扰功率达到能量检测门限时结果与波形模式不同，由调用者通过 MaxRxPowerDbm() 检查。
+class InterferenceController
+{
+  public:
+    InterferenceController(InterferenceMode mode,
+                           const NodeContainer &interferingNodes,
+                           const NetDeviceContainer &waveformGeneratorDevices,
+                           const NetDeviceContainer &wifiDevices,
+                           Ptr<PropagationLossModel> lossModel,
+                           double waveformPower,
+                           double rxNoiseFigureDb)
+        : m_mode(mode),
+          m_active(interferingNodes.GetN(), false),
+          m_rxNoiseFigureDb(rxNoiseFigureDb)
+    {
+        for (uint32_t i = 0; i < waveformGeneratorDevices.GetN(); ++i) {
+            m_generators.push_back(waveformGeneratorDevices.Get(i)
+                                       ->GetObject<NonCommunicatingNetDevice>()
+                                       ->GetPhy()
+                                       ->GetObject<WaveformGenerator>());
+        }
+        if (m_mode != INTERFERENCE_PSD) {
+            return;
+        }
+        for (uint32_t r = 0; r < wifiDevices.GetN(); ++r) {
+            Ptr<WifiPhy> phy = wifiDevices.Get(r)->GetObject<WifiNetDevice>()->GetPhy();
+            m_phys.push_back(phy);
+            // 与 InterferenceHelper 相同的热噪声计算方式
+            m_thermalNoise.push_back(1.3803e-23 * 290 * phy->GetChannelWidth() * 1e6);
+        }
+        // 预先计算每个干扰节点在每个 Wi-Fi 节点处的接收功率(W)
+        m_rxPower = Matrix<double>(interferingNodes.GetN(), m_phys.size(), 0);
+        for (uint32_t k = 0; k < interferingNodes.GetN(); ++k) {
+            Ptr<MobilityModel> a = interferingNodes.Get(k)->GetObject<MobilityModel>();
+            for (uint32_t r = 0; r < m_phys.size(); ++r) {
+                Ptr<MobilityModel> b = wifiDevices.Get(r)->GetNode()->GetObject<MobilityModel>();
+                double gainDb = lossModel->CalcRxPower(0, a, b);
+                m_rxPower[k][r] = waveformPower * std::pow(10.0, gainDb / 10);
+            }
+        }
+        UpdateNoiseFigures();
+    }
+
+    InterferenceMode GetMode() const
+    {
+        return m_mode;
+    }
+
+    // PSD 模式下所有干扰节点同时打开时，各 Wi-Fi 节点处干扰总功率的最大值(dBm)
+    double MaxRxPowerDbm() const
+    {
+        double maxPower = 0;
+        for (uint32_t r = 0; r < m_phys.size(); ++r) {
+            double power = 0;
+            for (uint32_t k = 0; k < m_active.size(); ++k) {
+                power += m_rxPower[k][r];
+            }
+            maxPower = std::max(maxPower, power);
+        }
+        return maxPower > 0 ? 10 * std::log10(maxPower) + 30 : -std::numeric_limits<double>::infinity();
+    }
+
+    // 打开或关闭第 k 个干扰节点
+    void SetActive(uint32_t k, bool on)
+    {
+        if (m_active.at(k) == on) {
+            return;
+        }
+        m_active[k] = on;
+        if (m_mode == INTERFERENCE_WAVEFORM) {
+            if (on) {
+                m_generators[k]->Start();
+            } else {
+                m_generators[k]->Stop();
+            }
+        } else {
+            UpdateNoiseFigures();
+        }
+    }
+
+    // 同时打开或关闭所有干扰节点，PSD 模式下只更新一次噪声
+    void SetAllActive(bool on)
+    {
+        bool changed = false;
+        for (uint32_t k = 0; k < m_active.size(); ++k) {
+            if (m_active[k] != on) {
+                changed = true;
+                if (m_mode == INTERFERENCE_WAVEFORM) {
+                    SetActive(k, on);
+                } else {
+                    m_active[k] = on;
+                }
+            }
+        }
+        if (changed && m_mode == INTERFERENCE_PSD) {
+            UpdateNoiseFigures();
+        }
+    }
+
+    // 快进模式下按测量时隙打开干扰节点：打开的时隙数从 0 变为 1 时打开全部干扰节点，
+    // 回到 0 时全部关闭，时隙之间的间隔和初始化阶段不产生任何干扰事件
+    void OpenWindow()
+    {
+        if (m_openWindows++ == 0) {
+            SetAllActive(true);
+        }
+    }
+
+    void CloseWindow()
+    {
+        NS_ASSERT_MSG(m_openWindows > 0, "CloseWindow without OpenWindow");
+        if (--m_openWindows == 0) {
+            SetAllActive(false);
+        }
+    }
+
+  private:
+    void UpdateNoiseFigures()
+    {
+        double baseNoiseFigure = std::pow(10.0, m_rxNoiseFigureDb / 10);
+        for (uint32_t r = 0; r < m_phys.size(); ++r) {
+            double interference = 0;
+            for (uint32_t k = 0; k < m_active.size(); ++k) {
+                if (m_active[k]) {
+                    interference += m_rxPower[k][r];
+                }
+            }
+            double noiseFigure = baseNoiseFigure + interference / m_thermalNoise[r];
+            m_phys[r]->SetRxNoiseFigure(10 * std::log10(noiseFigure));
+        }
+    }
+
+    InterferenceMode m_mode;
+    std::vector<bool> m_active;
+    double m_rxNoiseFigureDb;
+    std::vector<Ptr<WaveformGenerator>> m_generators;
+    std::vector<Ptr<WifiPhy>> m_phys;
+    std::vector<double> m_thermalNoise;
+    Matrix<double> m_rxPower; // [干扰节点][Wi-Fi节点]
+    uint32_t m_openWindows = 0;
+};
+
+#endif // INTERFERENCE_CONTROLLER_H
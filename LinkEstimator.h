@@ -0,0 +1,312 @@
+#ifndef LINK_ESTIMATOR_H
+#define LINK_ESTIMATOR_H
+
+#include "UtilityFunctions.h"
+
+#include "ns3/erp-ofdm-phy.h"
+#include "ns3/ofdm-phy.h"
+#include "ns3/table-based-error-rate-model.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+// 解析估计使用的物理层和业务参数，默认值与 ns-3.40 中场景的配置一致
+struct LinkEstimatorParams
+{
+    WifiMode mode;              // 数据帧的 MCS，即 modes[mcsIndex]
+    uint16_t channelWidth = 20; // MHz
+    WifiPhyBand band = WIFI_PHY_BAND_2_4GHZ;
+    double txPowerDbm = 16.0206;
+    double noiseFigureDb = 7;
+    double ccaEdThresholdDbm = -62;  // 非 Wi-Fi 信号(干扰节点)的能量检测门限
+    double minimumRssiDbm = -82;     // ThresholdPreambleDetectionModel 的 MinimumRssi
+    double preambleSnrDb = 4;        // ThresholdPreambleDetectionModel 的 Threshold
+    double interfererPower = 0;      // 每个干扰节点的带内发射功率(W)，即 waveformPower
+    uint32_t packetSize = 1420;      // 应用层负载(字节)
+    double offeredRate = 20;         // 每条流的发送速率(Mbps)
+    Time slot = MicroSeconds(9);
+    Time sifs = MicroSeconds(10);
+    uint32_t aifsn = 3;              // AC_BE
+    uint32_t cwMin = 15;
+    uint32_t cwMax = 1023;
+    uint32_t maxAttempts = 7;        // 发送次数上限(MaxSsrc)
+};
+
+// 只与位置有关的链路预算：接收功率和 SINR(未加修正量)，单位 dBm / dB
+struct LinkBudget
+{
+    Matrix<double> rxPowerDbm;
+    Matrix<double> sinrDb;
+    std::vector<double> interferenceDbm; // 每个 Wi-Fi 节点处所有干扰节点的带内功率之和
+};
+
+// 干扰节点一直处于发送状态，按传播损耗模型计算每个 Wi-Fi 节点处的干扰功率，
+// 噪声与 InterferenceController 相同为 kTB·NF，SINR = S / (N + I)
+LinkBudget ComputeLinkBudget(const LinkEstimatorParams &params, const NodeContainer &nodes,
+                             const NodeContainer &interferingNodes, Ptr<PropagationLossModel> lossModel)
+{
+    uint32_t n = nodes.GetN();
+    LinkBudget budget;
+    budget.rxPowerDbm = Matrix<double>(n, n, 0); // 对角线不使用，保持为 0 以便按矩阵格式保存
+    budget.sinrDb = Matrix<double>(n, n, 0);
+    budget.interferenceDbm.assign(n, -std::numeric_limits<double>::infinity());
+    double noise = 1.3803e-23 * 290 * params.channelWidth * 1e6 * std::pow(10.0, params.noiseFigureDb / 10);
+    std::vector<double> noisePlusInterference(n, noise);
+    for (uint32_t r = 0; r < n; ++r) {
+        Ptr<MobilityModel> b = nodes.Get(r)->GetObject<MobilityModel>();
+        double interference = 0;
+        for (uint32_t k = 0; k < interferingNodes.GetN(); ++k) {
+            Ptr<MobilityModel> a = interferingNodes.Get(k)->GetObject<MobilityModel>();
+            interference += params.interfererPower * std::pow(10.0, lossModel->CalcRxPower(0, a, b) / 10);
+        }
+        if (interference > 0) {
+            budget.interferenceDbm[r] = 10 * std::log10(interference) + 30;
+        }
+        noisePlusInterference[r] += interference;
+    }
+    for (uint32_t i = 0; i < n; ++i) {
+        Ptr<MobilityModel> a = nodes.Get(i)->GetObject<MobilityModel>();
+        for (uint32_t j = 0; j < n; ++j) {
+            if (i == j) {
+                continue;
+            }
+            Ptr<MobilityModel> b = nodes.Get(j)->GetObject<MobilityModel>();
+            double rxPowerDbm = lossModel->CalcRxPower(params.txPowerDbm, a, b);
+            budget.rxPowerDbm(i, j) = rxPowerDbm;
+            budget.sinrDb(i, j) = rxPowerDbm - 30 - 10 * std::log10(noisePlusInterference[j]);
+        }
+    }
+    return budget;
+}
+
+// 由链路预算按闭式公式估计链路测试的 psr(百分数)和吞吐率(Mbps，与 FlowMonitor 的统计口径相同)。
+// 每次发送的数据帧成功率 pd 和 ACK 成功率 pa 由 TableBasedErrorRateModel 给出，
+// 接收功率低于 MinimumRssi 或 SNR 低于前导检测门限时 pd 为 0；最多发送 maxAttempts 次，
+// 分组的投递概率为 1 - (1 - pd)^R，第 r 次发送的平均退避为 CW_r / 2 个时隙。
+// 发送节点处的干扰超过能量检测门限时信道一直忙，链路的 psr 和吞吐率都为 0。
+// 不考虑其他 Wi-Fi 流的竞争(链路测试中同一时隙的链路互不干扰)
+class LinkEstimator
+{
+  public:
+    explicit LinkEstimator(const LinkEstimatorParams &params)
+        : m_params(params),
+          m_errorModel(CreateObject<TableBasedErrorRateModel>())
+    {
+        m_dataTxVector.SetMode(params.mode);
+        m_dataTxVector.SetPreambleType(WIFI_PREAMBLE_HT_MF);
+        m_dataTxVector.SetChannelWidth(params.channelWidth);
+        m_dataTxVector.SetGuardInterval(800);
+        m_dataTxVector.SetNss(1);
+        // HT 数据帧的 ACK 以对应的非 HT 参考速率发送
+        uint64_t ackRate = params.mode.GetNonHtReferenceRate();
+        WifiMode ackMode = params.band == WIFI_PHY_BAND_2_4GHZ ? ErpOfdmPhy::GetErpOfdmRate(ackRate)
+                                                                : OfdmPhy::GetOfdmRate(ackRate);
+        m_ackTxVector.SetMode(ackMode);
+        m_ackTxVector.SetPreambleType(WIFI_PREAMBLE_LONG);
+        m_ackTxVector.SetChannelWidth(20);
+
+        m_mpduSize = params.packetSize + kUdpIpBytes + kMacOverheadBytes;
+        m_dataDuration = WifiPhy::CalculateTxDuration(m_mpduSize, m_dataTxVector, params.band).GetSeconds();
+        m_ackDuration = WifiPhy::CalculateTxDuration(kAckBytes, m_ackTxVector, params.band).GetSeconds();
+    }
+
+    // 估计全部链路，sinrOffsetDb 为在链路预算的 SINR 上附加的修正量
+    void Estimate(const LinkBudget &budget, double sinrOffsetDb, Matrix<double> *throughput, Matrix<double> *psr) const
+    {
+        size_t n = budget.sinrDb.Rows();
+        *throughput = Matrix<double>(n, n, 0);
+        *psr = Matrix<double>(n, n, 0);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                if (i != j) {
+                    EstimateLink(budget, i, j, sinrOffsetDb, &(*throughput)(i, j), &(*psr)(i, j));
+                }
+            }
+        }
+    }
+
+  private:
+    static const uint32_t kUdpIpBytes = 28;       // UDP(8) + IPv4(20)
+    static const uint32_t kMacOverheadBytes = 38; // LLC/SNAP(8) + QoS MAC 头(26) + FCS(4)
+    static const uint32_t kAckBytes = 14;
+
+    // 以前导检测门限为界的单帧成功率
+    double FrameSuccess(const WifiTxVector &txVector, double rxPowerDbm, double sinrDb, uint32_t bytes) const
+    {
+        if (rxPowerDbm < m_params.minimumRssiDbm || sinrDb < m_params.preambleSnrDb) {
+            return 0;
+        }
+        return m_errorModel->GetChunkSuccessRate(txVector.GetMode(), txVector, std::pow(10.0, sinrDb / 10),
+                                                 uint64_t(bytes) * 8);
+    }
+
+    void EstimateLink(const LinkBudget &budget, size_t i, size_t j, double offset, double *throughput,
+                      double *psr) const
+    {
+        if (budget.interferenceDbm[i] >= m_params.ccaEdThresholdDbm) {
+            return;
+        }
+        double pd = FrameSuccess(m_dataTxVector, budget.rxPowerDbm(i, j), budget.sinrDb(i, j) + offset, m_mpduSize);
+        double pa = FrameSuccess(m_ackTxVector, budget.rxPowerDbm(j, i), budget.sinrDb(j, i) + offset, kAckBytes);
+        double p = pd * pa;
+        double slot = m_params.slot.GetSeconds();
+        double sifs = m_params.sifs.GetSeconds();
+        double aifs = sifs + m_params.aifsn * slot;
+        // 每个分组占用信道的期望时间：第 r 次发送发生的概率为 (1 - p)^r
+        double serviceTime = 0;
+        double reach = 1;
+        uint32_t cw = m_params.cwMin;
+        for (uint32_t r = 0; r < m_params.maxAttempts; ++r) {
+            serviceTime += reach * (aifs + cw / 2.0 * slot + m_dataDuration + sifs + m_ackDuration);
+            reach *= 1 - p;
+            cw = std::min(2 * cw + 1, m_params.cwMax);
+        }
+        double delivered = 1 - std::pow(1 - pd, m_params.maxAttempts);
+        // 发送速率超过链路的服务速率时，多出的分组在 MAC 队列中超时丢弃
+        double offeredPackets = m_params.offeredRate * 1e6 / (m_params.packetSize * 8.0);
+        double servedPackets = std::min(offeredPackets, 1 / serviceTime);
+        double rxPackets = servedPackets * delivered;
+        *psr = std::round(rxPackets / offeredPackets * 100 * 1000.0) / 1000.0;
+        *throughput = std::round(rxPackets * (m_params.packetSize + kUdpIpBytes) * 8 / 1024 / 1024 * 1000.0) / 1000.0;
+    }
+
+    LinkEstimatorParams m_params;
+    Ptr<ErrorRateModel> m_errorModel;
+    WifiTxVector m_dataTxVector;
+    WifiTxVector m_ackTxVector;
+    uint32_t m_mpduSize = 0;
+    double m_dataDuration = 0;
+    double m_ackDuration = 0;
+};
+
+// 平均秩(并列取平均)，用于秩相关系数
+std::vector<double> AverageRanks(const std::vector<double> &values)
+{
+    std::vector<size_t> order(values.size());
+    for (size_t k = 0; k < order.size(); ++k) {
+        order[k] = k;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return values[a] < values[b]; });
+    std::vector<double> ranks(values.size());
+    for (size_t start = 0; start < order.size();) {
+        size_t end = start;
+        while (end + 1 < order.size() && values[order[end + 1]] == values[order[start]]) {
+            ++end;
+        }
+        for (size_t k = start; k <= end; ++k) {
+            ranks[order[k]] = (start + end) / 2.0;
+        }
+        start = end + 1;
+    }
+    return ranks;
+}
+
+// Spearman 秩相关系数，方差为零时为 0
+double RankCorrelation(const std::vector<double> &a, const std::vector<double> &b)
+{
+    std::vector<double> ra = AverageRanks(a);
+    std::vector<double> rb = AverageRanks(b);
+    size_t n = ra.size();
+    if (n < 2) {
+        return 0;
+    }
+    double meanA = std::accumulate(ra.begin(), ra.end(), 0.0) / n;
+    double meanB = std::accumulate(rb.begin(), rb.end(), 0.0) / n;
+    double cov = 0;
+    double varA = 0;
+    double varB = 0;
+    for (size_t k = 0; k < n; ++k) {
+        cov += (ra[k] - meanA) * (rb[k] - meanB);
+        varA += (ra[k] - meanA) * (ra[k] - meanA);
+        varB += (rb[k] - meanB) * (rb[k] - meanB);
+    }
+    return varA > 0 && varB > 0 ? cov / std::sqrt(varA * varB) : 0;
+}
+
+// 估计值与链路测试结果的比较
+struct EstimatorCalibration
+{
+    uint32_t links = 0;
+    double psrMae = 0;          // psr 的平均绝对误差(百分点)
+    double throughputMae = 0;   // 吞吐率的平均绝对误差(Mbps)
+    double psrRank = 0;         // psr 的 Spearman 秩相关系数
+    double throughputRank = 0;  // 吞吐率的 Spearman 秩相关系数
+    double usableAgreement = 0; // 按 psr >= 50% 判断链路可用时，估计与仿真一致的比例
+    double bestOffsetDb = 0;    // 使 psr 平均绝对误差最小的 SINR 修正量(在当前修正量之上)
+    double bestOffsetPsrMae = 0;
+};
+
+// 把估计结果与仿真的链路测试矩阵逐链路比较，写出 prefix_estimate_calibration.csv，
+// 并在 [-10, 10] dB 内以 0.5 dB 为步长搜索使 psr 误差最小的 SINR 修正量
+EstimatorCalibration CalibrateLinkEstimator(const LinkEstimator &estimator, const LinkBudget &budget,
+                                            double sinrOffsetDb, const Matrix<double> &simThroughput,
+                                            const Matrix<double> &simPsr, const std::string &prefix)
+{
+    size_t n = budget.sinrDb.Rows();
+    if (simPsr.Rows() != n || simPsr.Cols() != n || simThroughput.Rows() != n || simThroughput.Cols() != n) {
+        throw std::runtime_error("Link test matrices must be " + std::to_string(n) + "x" + std::to_string(n));
+    }
+    Matrix<double> psr;
+    Matrix<double> throughput;
+    estimator.Estimate(budget, sinrOffsetDb, &throughput, &psr);
+
+    std::string fileName = prefix + "_estimate_calibration.csv";
+    std::ofstream csv(fileName);
+    if (!csv.is_open()) {
+        throw std::runtime_error("Unable to open file " + fileName);
+    }
+    csv << "source,sink,rxPowerDbm,sinrDb,estPsr,simPsr,estThroughput,simThroughput" << std::endl;
+    EstimatorCalibration calibration;
+    std::vector<double> estPsr, measuredPsr, estThroughput, measuredThroughput;
+    uint32_t agree = 0;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            if (i == j) {
+                continue;
+            }
+            csv << i << "," << j << "," << budget.rxPowerDbm(i, j) << "," << budget.sinrDb(i, j) + sinrOffsetDb
+                << "," << psr(i, j) << "," << simPsr(i, j) << "," << throughput(i, j) << ","
+                << simThroughput(i, j) << std::endl;
+            calibration.psrMae += std::fabs(psr(i, j) - simPsr(i, j));
+            calibration.throughputMae += std::fabs(throughput(i, j) - simThroughput(i, j));
+            agree += (psr(i, j) >= 50) == (simPsr(i, j) >= 50) ? 1 : 0;
+            estPsr.push_back(psr(i, j));
+            measuredPsr.push_back(simPsr(i, j));
+            estThroughput.push_back(throughput(i, j));
+            measuredThroughput.push_back(simThroughput(i, j));
+        }
+    }
+    csv.close();
+    calibration.links = estPsr.size();
+    if (calibration.links == 0) {
+        return calibration;
+    }
+    calibration.psrMae /= calibration.links;
+    calibration.throughputMae /= calibration.links;
+    calibration.usableAgreement = double(agree) / calibration.links;
+    calibration.psrRank = RankCorrelation(estPsr, measuredPsr);
+    calibration.throughputRank = RankCorrelation(estThroughput, measuredThroughput);
+
+    calibration.bestOffsetPsrMae = calibration.psrMae;
+    for (int step = -20; step <= 20; ++step) {
+        double offset = step * 0.5;
+        estimator.Estimate(budget, sinrOffsetDb + offset, &throughput, &psr);
+        double mae = 0;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                if (i != j) {
+                    mae += std::fabs(psr(i, j) - simPsr(i, j));
+                }
+            }
+        }
+        mae /= calibration.links;
+        if (mae < calibration.bestOffsetPsrMae) {
+            calibration.bestOffsetPsrMae = mae;
+            calibration.bestOffsetDb = offset;
+        }
+    }
+    return calibration;
+}
+
+#endif // LINK_ESTIMATOR_H
@@ -0,0 +1,91 @@
+#ifndef LINK_SCHEDULER_H
+#define LINK_SCHEDULER_H
+
+#include "UtilityFunctions.h"
+
+#include <algorithm>
+#include <utility>
+
+// 一条待测链路：(源节点, 汇节点)
+typedef std::pair<uint16_t, uint16_t> Link;
+
+// 计算节点之间的载波侦听关系：hears[i][j] 为 true 表示节点 j 能侦听到节点 i 的发送
+Matrix<bool> ComputeCarrierSenseMatrix(
+    const NodeContainer &nodes,
+    Ptr<PropagationLossModel> lossModel,
+    double txPowerDbm,
+    double csThresholdDbm)
+{
+    uint32_t n = nodes.GetN();
+    Matrix<bool> hears(n, n, false);
+    for (uint32_t i = 0; i < n; ++i) {
+        Ptr<MobilityModel> a = nodes.Get(i)->GetObject<MobilityModel>();
+        for (uint32_t j = 0; j < n; ++j) {
+            if (i == j) {
+                continue;
+            }
+            Ptr<MobilityModel> b = nodes.Get(j)->GetObject<MobilityModel>();
+            hears[i][j] = lossModel->CalcRxPower(txPowerDbm, a, b) >= csThresholdDbm;
+        }
+    }
+    return hears;
+}
+
+// 根据冲突图为链路测试分配时隙，同一时隙内的链路互不干扰，可以同时测量。
+// 两条链路冲突的条件：共享端点，或者任意一条链路的某个端点(数据帧发送方或ACK发送方)
+// 能被另一条链路的某个端点侦听到。采用按冲突度降序的贪心着色(Welsh-Powell)，
+// 每个时隙维护一个"被占用节点"集合，判断冲突只需 O(1)，避免显式构建 O(L^2) 的冲突图。
+std::vector<std::vector<Link>> BuildConcurrentLinkSchedule(
+    const std::vector<Link> &links,
+    const Matrix<bool> &hears)
+{
+    size_t n = hears.Rows();
+    // 与节点 x 冲突的节点集合(包括自身)
+    auto markNeighbours = [&](std::vector<bool> &blocked, uint16_t x) {
+        blocked[x] = true;
+        for (size_t y = 0; y < n; ++y) {
+            if (hears[x][y] || hears[y][x]) {
+                blocked[y] = true;
+            }
+        }
+    };
+    std::vector<size_t> degree(n, 0);
+    for (size_t x = 0; x < n; ++x) {
+        for (size_t y = 0; y < n; ++y) {
+            if (x != y && (hears[x][y] || hears[y][x])) {
+                degree[x]++;
+            }
+        }
+    }
+
+    // 冲突度高的链路优先着色，相同冲突度时保持原有的顺序
+    std::vector<size_t> order(links.size());
+    for (size_t k = 0; k < links.size(); ++k) {
+        order[k] = k;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return degree[links[a].first] + degree[links[a].second] >
+               degree[links[b].first] + degree[links[b].second];
+    });
+
+    std::vector<std::vector<Link>> slots;
+    std::vector<std::vector<bool>> blocked; // 每个时隙中已被占用的节点
+    for (size_t k : order) {
+        const Link &link = links[k];
+        size_t slot = 0;
+        while (slot < slots.size() &&
+               (blocked[slot][link.first] || blocked[slot][link.second])) {
+            ++slot;
+        }
+        if (slot == slots.size()) {
+            slots.emplace_back();
+            blocked.emplace_back(n, false);
+        }
+        slots[slot].push_back(link);
+        markNeighbours(blocked[slot], link.first);
+        markNeighbours(blocked[slot], link.second);
+    }
+    return slots;
+}
+
+#endif // LINK_SCHEDULER_H
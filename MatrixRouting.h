@@ -0,0 +1,280 @@
+#ifndef MATRIX_ROUTING_H
+#define MATRIX_ROUTING_H
+
+#include "UtilityFunctions.h"
+
+#include "ns3/ipv4-interface-container.h"
+#include "ns3/ipv4-routing-helper.h"
+#include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4.h"
+#include "ns3/node-container.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/socket.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+// 所有节点共享的下一跳矩阵，按目的主机编号直接索引。
+// SetTable 先构造好新的矩阵再整体替换，正在运行的仿真中一次调用即可切换全部节点的路由
+class MatrixRoutingTable : public SimpleRefCount<MatrixRoutingTable>
+{
+  public:
+    explicit MatrixRoutingTable(const NodeContainer &nodes)
+        : m_n(nodes.GetN())
+    {
+        for (uint32_t i = 0; i < m_n; ++i) {
+            m_hostIds[nodes.Get(i)->GetId()] = i;
+        }
+    }
+
+    // 记录每个主机的地址，需要在分配IP地址之后调用
+    void SetAddresses(const Ipv4InterfaceContainer &interfaces)
+    {
+        m_addresses.resize(m_n);
+        m_addressIds.clear();
+        for (uint32_t i = 0; i < m_n; ++i) {
+            m_addresses[i] = interfaces.GetAddress(i, 0);
+            m_addressIds[m_addresses[i].Get()] = i;
+        }
+    }
+
+    // 整体替换下一跳矩阵，routingTable[i][j] 为节点 i 到节点 j 的下一跳，-1 表示无路由
+    void SetTable(const Matrix<int> &routingTable)
+    {
+        std::shared_ptr<Matrix<int>> table;
+        if (routingTable.Rows() == m_n && routingTable.Cols() == m_n) {
+            table = std::make_shared<Matrix<int>>(routingTable.Clone());
+        } else {
+            table = std::make_shared<Matrix<int>>(m_n, m_n, -1);
+            for (uint32_t i = 0; i < m_n && i < routingTable.Rows(); ++i) {
+                for (uint32_t j = 0; j < m_n && j < routingTable.Cols(); ++j) {
+                    (*table)(i, j) = routingTable(i, j);
+                }
+            }
+        }
+        m_nextHop = table;
+        m_version++;
+    }
+
+    // 每个节点直接发送到目的节点
+    void SetDirectTable()
+    {
+        Matrix<int> routingTable(m_n, m_n, -1);
+        for (uint32_t i = 0; i < m_n; ++i) {
+            for (uint32_t j = 0; j < m_n; ++j) {
+                if (i != j) {
+                    routingTable[i][j] = j;
+                }
+            }
+        }
+        SetTable(routingTable);
+    }
+
+    // 节点 i 到节点 j 的下一跳，-1 表示无路由
+    int32_t GetNextHop(uint32_t i, uint32_t j) const
+    {
+        return m_nextHop ? (*m_nextHop)(i, j) : -1;
+    }
+
+    // 地址对应的主机编号，-1 表示不在表中
+    int32_t GetHostIdByAddress(Ipv4Address address) const
+    {
+        auto it = m_addressIds.find(address.Get());
+        return it == m_addressIds.end() ? -1 : int32_t(it->second);
+    }
+
+    int32_t GetHostIdByNode(uint32_t nodeId) const
+    {
+        auto it = m_hostIds.find(nodeId);
+        return it == m_hostIds.end() ? -1 : int32_t(it->second);
+    }
+
+    Ipv4Address GetAddress(uint32_t hostId) const
+    {
+        return m_addresses.at(hostId);
+    }
+
+    uint32_t GetN() const
+    {
+        return m_n;
+    }
+
+    uint64_t GetVersion() const
+    {
+        return m_version;
+    }
+
+  private:
+    uint32_t m_n;
+    std::shared_ptr<const Matrix<int>> m_nextHop;
+    uint64_t m_version = 0;
+    std::unordered_map<uint32_t, uint32_t> m_hostIds;    // 节点ID -> 主机编号
+    std::unordered_map<uint32_t, uint32_t> m_addressIds; // 地址 -> 主机编号
+    std::vector<Ipv4Address> m_addresses;
+};
+
+// 基于共享下一跳矩阵的路由协议，RouteOutput / RouteInput 都是 O(1) 查表。
+// 每个节点只有一个 Wi-Fi 接口，路由对象按目的节点缓存，矩阵替换后自动失效
+class MatrixRouting : public Ipv4RoutingProtocol
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid = TypeId("ns3::MatrixRouting")
+                                .SetParent<Ipv4RoutingProtocol>()
+                                .SetGroupName("Internet");
+        return tid;
+    }
+
+    MatrixRouting(Ptr<MatrixRoutingTable> table, uint32_t hostId)
+        : m_table(table),
+          m_hostId(hostId)
+    {
+    }
+
+    Ptr<Ipv4Route> RouteOutput(Ptr<Packet> p,
+                               const Ipv4Header &header,
+                               Ptr<NetDevice> oif,
+                               Socket::SocketErrno &sockerr) override
+    {
+        Ptr<Ipv4Route> route = Lookup(header.GetDestination());
+        sockerr = route ? Socket::ERROR_NOTERROR : Socket::ERROR_NOROUTETOHOST;
+        return route;
+    }
+
+    bool RouteInput(Ptr<const Packet> p,
+                    const Ipv4Header &header,
+                    Ptr<const NetDevice> idev,
+                    const UnicastForwardCallback &ucb,
+                    const MulticastForwardCallback &mcb,
+                    const LocalDeliverCallback &lcb,
+                    const ErrorCallback &ecb) override
+    {
+        uint32_t iif = m_ipv4->GetInterfaceForDevice(idev);
+        if (m_ipv4->IsDestinationAddress(header.GetDestination(), iif)) {
+            if (!lcb.IsNull()) {
+                lcb(p, header, iif);
+                return true;
+            }
+            return false;
+        }
+        if (!m_ipv4->IsForwarding(iif)) {
+            ecb(p, header, Socket::ERROR_NOROUTETOHOST);
+            return true;
+        }
+        Ptr<Ipv4Route> route = Lookup(header.GetDestination());
+        if (!route) {
+            return false;
+        }
+        ucb(route, p, header);
+        return true;
+    }
+
+    void NotifyInterfaceUp(uint32_t interface) override
+    {
+    }
+
+    void NotifyInterfaceDown(uint32_t interface) override
+    {
+    }
+
+    void NotifyAddAddress(uint32_t interface, Ipv4InterfaceAddress address) override
+    {
+        // 第一个非环回地址所在的接口即为 Wi-Fi 接口
+        if (m_interface == 0 && address.GetLocal() != Ipv4Address::GetLoopback()) {
+            m_interface = interface;
+            m_routes.clear();
+        }
+    }
+
+    void NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress address) override
+    {
+    }
+
+    void SetIpv4(Ptr<Ipv4> ipv4) override
+    {
+        m_ipv4 = ipv4;
+    }
+
+    void PrintRoutingTable(Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const override
+    {
+        std::ostream *os = stream->GetStream();
+        *os << "Node host id " << m_hostId << ", table version " << m_table->GetVersion() << std::endl;
+        *os << "Destination     Gateway" << std::endl;
+        for (uint32_t j = 0; j < m_table->GetN(); ++j) {
+            int32_t nextHop = m_table->GetNextHop(m_hostId, j);
+            if (j != m_hostId && nextHop >= 0) {
+                *os << m_table->GetAddress(j) << "        " << m_table->GetAddress(nextHop) << std::endl;
+            }
+        }
+    }
+
+  private:
+    Ptr<Ipv4Route> Lookup(Ipv4Address destination)
+    {
+        if (m_routesVersion != m_table->GetVersion()) {
+            m_routes.clear();
+            m_routesVersion = m_table->GetVersion();
+        }
+        int32_t dest = m_table->GetHostIdByAddress(destination);
+        if (dest < 0 || uint32_t(dest) == m_hostId || m_interface == 0) {
+            return nullptr;
+        }
+        if (m_routes.empty()) {
+            m_routes.resize(m_table->GetN());
+        }
+        Ptr<Ipv4Route> &route = m_routes[dest];
+        if (!route) {
+            int32_t nextHop = m_table->GetNextHop(m_hostId, dest);
+            if (nextHop < 0) {
+                return nullptr;
+            }
+            route = Create<Ipv4Route>();
+            route->SetDestination(destination);
+            route->SetGateway(m_table->GetAddress(nextHop));
+            route->SetSource(m_ipv4->GetAddress(m_interface, 0).GetLocal());
+            route->SetOutputDevice(m_ipv4->GetNetDevice(m_interface));
+        }
+        return route;
+    }
+
+    Ptr<MatrixRoutingTable> m_table;
+    uint32_t m_hostId;
+    Ptr<Ipv4> m_ipv4;
+    uint32_t m_interface = 0;
+    std::vector<Ptr<Ipv4Route>> m_routes; // 按目的主机编号缓存的路由
+    uint64_t m_routesVersion = 0;
+};
+
+// 通过 InternetStackHelper::SetRoutingHelper 为每个节点安装 MatrixRouting
+class MatrixRoutingHelper : public Ipv4RoutingHelper
+{
+  public:
+    explicit MatrixRoutingHelper(Ptr<MatrixRoutingTable> table)
+        : m_table(table)
+    {
+    }
+
+    MatrixRoutingHelper *Copy() const override
+    {
+        return new MatrixRoutingHelper(*this);
+    }
+
+    Ptr<Ipv4RoutingProtocol> Create(Ptr<Node> node) const override
+    {
+        int32_t hostId = m_table->GetHostIdByNode(node->GetId());
+        NS_ABORT_MSG_IF(hostId < 0, "Node " << node->GetId() << " is not in the routing matrix");
+        return CreateObject<MatrixRouting>(m_table, hostId);
+    }
+
+  private:
+    Ptr<MatrixRoutingTable> m_table;
+};
+
+} // namespace ns3
+
+#endif // MATRIX_ROUTING_H
@@ -0,0 +1,200 @@
+#ifndef MATRIX_STORE_H
+#define MATRIX_STORE_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// 二进制矩阵文件格式：64 字节的文件头 + 按行优先连续存放的矩阵数据(小端序)
+// 读取时直接 mmap 整个文件，矩阵数据不需要解析和拷贝
+enum MatrixDType : uint32_t
+{
+    MATRIX_INT32 = 1,
+    MATRIX_FLOAT64 = 2,
+};
+
+struct MatrixFileHeader
+{
+    char magic[8];        // "NS3MTX"
+    uint32_t version;
+    uint32_t dtype;       // MatrixDType
+    uint64_t rows;
+    uint64_t cols;
+    uint32_t nodes;       // 无线节点数量 N
+    uint32_t seed;        // 随机种子
+    uint64_t configHash;  // 生成该矩阵的场景配置的哈希值，未知时为0
+    uint64_t reserved[2];
+};
+static_assert(sizeof(MatrixFileHeader) == 64, "MatrixFileHeader must stay 64 bytes");
+
+static const char kMatrixMagic[8] = {'N', 'S', '3', 'M', 'T', 'X', 0, 0};
+static const uint32_t kMatrixVersion = 1;
+
+template <typename T>
+struct MatrixDTypeOf;
+template <>
+struct MatrixDTypeOf<int>
+{
+    static const uint32_t value = MATRIX_INT32;
+};
+template <>
+struct MatrixDTypeOf<double>
+{
+    static const uint32_t value = MATRIX_FLOAT64;
+};
+
+// 文本矩阵文件对应的二进制文件名，xxx_matrix.txt -> xxx_matrix.bin
+std::string BinaryMatrixFileName(const std::string& textFileName) {
+    std::filesystem::path path(textFileName);
+    return path.replace_extension(".bin").string();
+}
+
+// 保存为二进制矩阵文件，data 为按行优先连续存放的 rows×cols 个元素，整块写入。
+// 先写入临时文件再重命名，避免其他进程读到写了一半的文件
+template <typename T>
+void SaveMatrixToBinaryFile(const T* data, size_t rows, size_t cols, const std::string& filename,
+                            uint32_t nodes = 0, uint32_t seed = 0, uint64_t configHash = 0) {
+    MatrixFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMatrixMagic, sizeof(header.magic));
+    header.version = kMatrixVersion;
+    header.dtype = MatrixDTypeOf<T>::value;
+    header.rows = rows;
+    header.cols = cols;
+    header.nodes = nodes;
+    header.seed = seed;
+    header.configHash = configHash;
+
+    std::string tmpName = filename + ".tmp" + std::to_string(getpid());
+    std::ofstream file(tmpName, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open file " + tmpName);
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(data), rows * cols * sizeof(T));
+    file.close();
+    std::filesystem::rename(tmpName, filename);
+}
+
+// 以 mmap 方式打开的二进制矩阵，只能移动不能拷贝。
+// 映射为私有的写时复制页面：修改只复制被写的页，不会写回文件。
+// 保存矩阵时先写临时文件再重命名，已经建立的映射仍然指向原来的文件内容
+template <typename T>
+class MappedMatrix
+{
+  public:
+    explicit MappedMatrix(const std::string& filename) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("File " + filename + " not found");
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(MatrixFileHeader)) {
+            close(fd);
+            throw std::runtime_error("File " + filename + " is not a binary matrix");
+        }
+        m_size = st.st_size;
+        m_base = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        close(fd); // 映射建立后即可关闭文件描述符
+        if (m_base == MAP_FAILED) {
+            m_base = nullptr;
+            throw std::runtime_error("Unable to mmap file " + filename);
+        }
+        const MatrixFileHeader* header = static_cast<const MatrixFileHeader*>(m_base);
+        if (std::memcmp(header->magic, kMatrixMagic, sizeof(kMatrixMagic)) != 0 ||
+            header->version != kMatrixVersion) {
+            Unmap();
+            throw std::runtime_error("File " + filename + " is not a binary matrix");
+        }
+        if (header->dtype != MatrixDTypeOf<T>::value) {
+            Unmap();
+            throw std::runtime_error("File " + filename + " has a different element type");
+        }
+        if (m_size < sizeof(MatrixFileHeader) + header->rows * header->cols * sizeof(T)) {
+            Unmap();
+            throw std::runtime_error("File " + filename + " is truncated");
+        }
+    }
+
+    ~MappedMatrix() {
+        Unmap();
+    }
+
+    MappedMatrix(const MappedMatrix&) = delete;
+    MappedMatrix& operator=(const MappedMatrix&) = delete;
+
+    MappedMatrix(MappedMatrix&& other) noexcept
+        : m_base(other.m_base),
+          m_size(other.m_size) {
+        other.m_base = nullptr;
+        other.m_size = 0;
+    }
+
+    MappedMatrix& operator=(MappedMatrix&& other) noexcept {
+        if (this != &other) {
+            Unmap();
+            m_base = other.m_base;
+            m_size = other.m_size;
+            other.m_base = nullptr;
+            other.m_size = 0;
+        }
+        return *this;
+    }
+
+    const MatrixFileHeader& Header() const {
+        return *static_cast<const MatrixFileHeader*>(m_base);
+    }
+
+    size_t Rows() const {
+        return Header().rows;
+    }
+
+    size_t Cols() const {
+        return Header().cols;
+    }
+
+    const T* Data() const {
+        return reinterpret_cast<const T*>(static_cast<const char*>(m_base) + sizeof(MatrixFileHeader));
+    }
+
+    T* MutableData() {
+        return reinterpret_cast<T*>(static_cast<char*>(m_base) + sizeof(MatrixFileHeader));
+    }
+
+    T operator()(size_t i, size_t j) const {
+        return Data()[i * Cols() + j];
+    }
+
+  private:
+    void Unmap() {
+        if (m_base != nullptr) {
+            munmap(m_base, m_size);
+            m_base = nullptr;
+        }
+    }
+
+    void* m_base = nullptr;
+    size_t m_size = 0;
+};
+
+// 读取二进制矩阵文件头中的元素类型
+uint32_t ReadMatrixDType(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    MatrixFileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, kMatrixMagic, sizeof(kMatrixMagic)) != 0) {
+        throw std::runtime_error("File " + filename + " is not a binary matrix");
+    }
+    return header.dtype;
+}
+
+#endif // MATRIX_STORE_H
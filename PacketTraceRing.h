@@ -0,0 +1,206 @@
+#ifndef PACKET_TRACE_RING_H
+#define PACKET_TRACE_RING_H
+
+#include "UtilityFunctions.h"
+
+// 环形缓冲区中的一条 PHY/MAC 事件
+struct PacketTraceEvent
+{
+    double time = 0;
+    uint64_t uid = 0;  // 分组的 UID
+    uint32_t size = 0; // 字节数
+    float value = 0;   // PhyTx 为发射功率(dBm)，PhyRxDrop 为失败原因的编号
+    uint8_t type = 0;
+};
+
+// 每个 Wi-Fi 节点只保留最近 capacity 条 PHY/MAC 事件的轻量跟踪，代替全程的 PCAP/ASCII 跟踪。
+// 所有缓冲区在安装时一次性分配，记录事件时不分配内存也不写文件；
+// sampling 为记录的比例，按分组 UID 的乘法散列确定性地抽样：同一个分组在所有节点上的事件
+// 要么全部记录要么全部跳过，不消耗随机数，不改变仿真结果。
+// 只有触发条件满足(流的 psr 低于门限或到达指定时刻)时才把全部缓冲区写入 prefix_trace_<k>.csv，
+// 写出的文件数不超过 maxDumps
+class PacketTraceRing
+{
+  public:
+    enum EventType : uint8_t
+    {
+        PHY_TX,
+        PHY_RX_OK,
+        PHY_RX_DROP,
+        MAC_TX,
+        MAC_TX_DROP,
+        MAC_RX,
+    };
+
+    // capacity 为 0 表示不跟踪
+    PacketTraceRing(uint32_t capacity, double sampling, double psrThreshold, uint32_t maxDumps,
+                    const std::string &outputPrefix)
+        : m_capacity(capacity),
+          m_sampling(sampling),
+          m_sampleThreshold(sampling < 1 ? uint64_t(std::ldexp(sampling, 64)) : 0),
+          m_psrThreshold(psrThreshold),
+          m_maxDumps(maxDumps),
+          m_outputPrefix(outputPrefix)
+    {
+        if (Enabled() && (sampling <= 0 || sampling > 1)) {
+            throw std::runtime_error("Trace sampling rate must be in (0, 1]");
+        }
+    }
+
+    bool Enabled() const
+    {
+        return m_capacity > 0;
+    }
+
+    // 在每个 Wi-Fi 设备的 PHY 和 MAC 上挂接回调，第 i 个设备对应第 i 个节点
+    void Install(const NetDeviceContainer &devices)
+    {
+        if (!Enabled()) {
+            return;
+        }
+        uint32_t n = devices.GetN();
+        m_events.assign(size_t(n) * m_capacity, PacketTraceEvent());
+        m_nodes.assign(n, NodeRing());
+        for (uint32_t i = 0; i < n; ++i) {
+            Ptr<WifiNetDevice> device = devices.Get(i)->GetObject<WifiNetDevice>();
+            Ptr<WifiPhy> phy = device->GetPhy();
+            phy->TraceConnectWithoutContext("PhyTxBegin", MakeBoundCallback(&PacketTraceRing::PhyTx, this, i));
+            phy->TraceConnectWithoutContext("PhyRxEnd", MakeBoundCallback(&PacketTraceRing::PhyRxOk, this, i));
+            phy->TraceConnectWithoutContext("PhyRxDrop", MakeBoundCallback(&PacketTraceRing::PhyRxDrop, this, i));
+            Ptr<WifiMac> mac = device->GetMac();
+            mac->TraceConnectWithoutContext("MacTx", MakeBoundCallback(&PacketTraceRing::MacTx, this, i));
+            mac->TraceConnectWithoutContext("MacTxDrop", MakeBoundCallback(&PacketTraceRing::MacTxDrop, this, i));
+            mac->TraceConnectWithoutContext("MacRx", MakeBoundCallback(&PacketTraceRing::MacRx, this, i));
+        }
+    }
+
+    // 在 time 时刻无条件写出一次缓冲区
+    void ScheduleDump(double time)
+    {
+        if (Enabled()) {
+            Simulator::Schedule(Seconds(time), &PacketTraceRing::Dump, this, std::string("time"));
+        }
+    }
+
+    // 由 CalculateThroughput 调用：psr(百分数)低于门限时写出缓冲区
+    void CheckFlow(uint16_t source, uint16_t sink, double psr)
+    {
+        if (Enabled() && psr < m_psrThreshold) {
+            Dump("flow " + std::to_string(source) + "->" + std::to_string(sink) + " psr=" + std::to_string(psr));
+        }
+    }
+
+    // 把每个节点缓冲区中的事件按时间先后写入一个新文件
+    void Dump(const std::string &reason)
+    {
+        if (m_dumps >= m_maxDumps) {
+            m_suppressed++;
+            return;
+        }
+        std::string fileName = m_outputPrefix + "_trace_" + std::to_string(m_dumps++) + ".csv";
+        std::ofstream out(fileName);
+        if (!out.is_open()) {
+            throw std::runtime_error("Unable to open file " + fileName);
+        }
+        static const char *names[] = {"PhyTx", "PhyRxOk", "PhyRxDrop", "MacTx", "MacTxDrop", "MacRx"};
+        out << "# time=" << Simulator::Now().GetSeconds() << " reason=" << reason << "\n";
+        out << "node,time,event,uid,size,value\n";
+        for (uint32_t node = 0; node < m_nodes.size(); ++node) {
+            const NodeRing &ring = m_nodes[node];
+            const PacketTraceEvent *events = &m_events[size_t(node) * m_capacity];
+            uint32_t first = ring.count < m_capacity ? 0 : ring.next;
+            for (uint32_t k = 0; k < ring.count; ++k) {
+                const PacketTraceEvent &event = events[(first + k) % m_capacity];
+                out << node << "," << event.time << "," << names[event.type] << "," << event.uid << ","
+                    << event.size << "," << event.value << "\n";
+            }
+        }
+        NS_LOG_INFO("跟踪缓冲区已写入 " << fileName << " (" << reason << ")");
+    }
+
+    uint32_t GetDumps() const
+    {
+        return m_dumps;
+    }
+
+    // 因超过 maxDumps 而没有写出的触发次数
+    uint32_t GetSuppressed() const
+    {
+        return m_suppressed;
+    }
+
+  private:
+    struct NodeRing
+    {
+        uint32_t next = 0;  // 下一条事件写入的位置
+        uint32_t count = 0; // 缓冲区中的事件数，不超过 capacity
+    };
+
+    // 黄金分割乘法散列：uid * 2^64/phi 在 [0, 2^64) 上均匀分布，低于 sampling * 2^64 的分组被记录
+    bool Sampled(uint64_t uid) const
+    {
+        static const uint64_t kGolden = 0x9E3779B97F4A7C15ULL;
+        return m_sampling >= 1 || uid * kGolden < m_sampleThreshold;
+    }
+
+    void Record(uint32_t node, EventType type, Ptr<const Packet> packet, float value)
+    {
+        uint64_t uid = packet->GetUid();
+        if (!Sampled(uid)) {
+            return;
+        }
+        NodeRing &ring = m_nodes[node];
+        PacketTraceEvent &event = m_events[size_t(node) * m_capacity + ring.next];
+        event.time = Simulator::Now().GetSeconds();
+        event.uid = uid;
+        event.size = packet->GetSize();
+        event.value = value;
+        event.type = type;
+        ring.next = ring.next + 1 == m_capacity ? 0 : ring.next + 1;
+        ring.count = std::min(ring.count + 1, m_capacity);
+    }
+
+    static void PhyTx(PacketTraceRing *ring, uint32_t node, Ptr<const Packet> packet, double txPowerW)
+    {
+        ring->Record(node, PHY_TX, packet, 10 * std::log10(txPowerW) + 30);
+    }
+
+    static void PhyRxOk(PacketTraceRing *ring, uint32_t node, Ptr<const Packet> packet)
+    {
+        ring->Record(node, PHY_RX_OK, packet, 0);
+    }
+
+    static void PhyRxDrop(PacketTraceRing *ring, uint32_t node, Ptr<const Packet> packet,
+                          WifiPhyRxfailureReason reason)
+    {
+        ring->Record(node, PHY_RX_DROP, packet, reason);
+    }
+
+    static void MacTx(PacketTraceRing *ring, uint32_t node, Ptr<const Packet> packet)
+    {
+        ring->Record(node, MAC_TX, packet, 0);
+    }
+
+    static void MacTxDrop(PacketTraceRing *ring, uint32_t node, Ptr<const Packet> packet)
+    {
+        ring->Record(node, MAC_TX_DROP, packet, 0);
+    }
+
+    static void MacRx(PacketTraceRing *ring, uint32_t node, Ptr<const Packet> packet)
+    {
+        ring->Record(node, MAC_RX, packet, 0);
+    }
+
+    uint32_t m_capacity;
+    double m_sampling;
+    uint64_t m_sampleThreshold; // sampling * 2^64，sampling 为 1 时不使用
+    double m_psrThreshold;
+    uint32_t m_maxDumps;
+    std::string m_outputPrefix;
+    std::vector<PacketTraceEvent> m_events; // 按节点分段的环形缓冲区，每段 capacity 条
+    std::vector<NodeRing> m_nodes;
+    uint32_t m_dumps = 0;
+    uint32_t m_suppressed = 0;
+};
+
+#endif // PACKET_TRACE_RING_H
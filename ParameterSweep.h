@@ -0,0 +1,534 @@
+#ifndef PARAMETER_SWEEP_H
+#define PARAMETER_SWEEP_H
+
+#include "WifiScenario.h"
+
+#include <functional>
+#include <map>
+#include <thread>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+// 参数扫描的配置：网格扫描时每一项为逗号分隔的取值列表，为空表示不扫描该参数
+struct SweepOptions
+{
+    string seeds = "";
+    string powers = "";
+    string interferers = ""; // M
+    string mcs = "";
+    string datarates = "";
+    string file = ""; // 每行一个场景，格式为空格分隔的 key=value
+    string output = ""; // 汇总结果文件，默认为 outputDir/sweep_results.csv
+    uint32_t jobs = 0; // 并行进程数，0 表示使用全部CPU核
+    // 公共随机数重复仿真：比较这些干扰功率(第一个为基准)，每次重复的各个功率使用相同的 run
+    string crnPowers = "";
+    string crnMetric = "throughput"; // 比较的指标，取自场景结果摘要
+    double crnPrecision = 0.1; // 每个配对差值的 95% 置信区间半宽达到该值(指标的单位)后停止
+    uint32_t crnMinReps = 3;
+    uint32_t crnMaxReps = 50;
+
+    bool Enabled() const
+    {
+        return !(seeds.empty() && powers.empty() && interferers.empty() && mcs.empty() &&
+                 datarates.empty() && file.empty());
+    }
+};
+
+void AddSweepOptions(CommandLine &cmd, SweepOptions &sweep)
+{
+    cmd.AddValue("sweepSeeds", "参数扫描：随机种子列表，例如 2000,2001,2002", sweep.seeds);
+    cmd.AddValue("sweepPowers", "参数扫描：干扰功率列表", sweep.powers);
+    cmd.AddValue("sweepM", "参数扫描：干扰节点数量列表", sweep.interferers);
+    cmd.AddValue("sweepMcs", "参数扫描：MCS索引列表", sweep.mcs);
+    cmd.AddValue("sweepDatarates", "参数扫描：app发送速率列表", sweep.datarates);
+    cmd.AddValue("sweepFile", "参数扫描：场景列表文件，每行为空格分隔的 key=value", sweep.file);
+    cmd.AddValue("sweepOutput", "参数扫描：汇总结果文件", sweep.output);
+    cmd.AddValue("jobs", "参数扫描：并行进程数，0表示使用全部CPU核", sweep.jobs);
+    cmd.AddValue("crnPowers", "公共随机数重复仿真：比较的干扰功率列表，第一个为基准，例如 10,20,40", sweep.crnPowers);
+    cmd.AddValue("crnMetric", "公共随机数重复仿真比较的指标：throughput、psr、meanThroughput、meanPsr 或 goodput", sweep.crnMetric);
+    cmd.AddValue("crnPrecision", "配对差值95%置信区间半宽的目标(指标的单位)，全部达到后停止增加重复次数", sweep.crnPrecision);
+    cmd.AddValue("crnMinReps", "公共随机数重复仿真的最少重复次数", sweep.crnMinReps);
+    cmd.AddValue("crnMaxReps", "公共随机数重复仿真的最多重复次数", sweep.crnMaxReps);
+}
+
+// 按分隔符切分字符串，忽略空项
+vector<string> SplitString(const string &text, char delimiter)
+{
+    vector<string> items;
+    string item;
+    istringstream iss(text);
+    while (getline(iss, item, delimiter)) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+// 生成全部扫描点，每个点是一组 key=value 参数
+vector<vector<string>> BuildSweepPoints(const SweepOptions &sweep)
+{
+    vector<vector<string>> points;
+    if (!sweep.file.empty()) {
+        ifstream input(sweep.file);
+        if (!input.is_open()) {
+            throw runtime_error("File " + sweep.file + " not found");
+        }
+        string line;
+        while (getline(input, line)) {
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            points.push_back(SplitString(line, ' '));
+        }
+    }
+
+    // 网格扫描：对每个给出的参数做笛卡尔积
+    vector<pair<string, vector<string>>> axes;
+    auto addAxis = [&](const string &key, const string &values) {
+        if (!values.empty()) {
+            axes.push_back(make_pair(key, SplitString(values, ',')));
+        }
+    };
+    addAxis("seed", sweep.seeds);
+    addAxis("power", sweep.powers);
+    addAxis("M", sweep.interferers);
+    addAxis("mcsIndex", sweep.mcs);
+    addAxis("datarate", sweep.datarates);
+    if (!axes.empty()) {
+        vector<vector<string>> grid = {{}};
+        for (const auto &axis : axes) {
+            vector<vector<string>> next;
+            for (const auto &prefix : grid) {
+                for (const auto &value : axis.second) {
+                    vector<string> point = prefix;
+                    point.push_back(axis.first + "=" + value);
+                    next.push_back(point);
+                }
+            }
+            grid.swap(next);
+        }
+        points.insert(points.end(), grid.begin(), grid.end());
+    }
+    return points;
+}
+
+// 由扫描点生成结果文件名后缀，N 和 seed 已经包含在文件前缀中
+string SweepPointTag(const vector<string> &options)
+{
+    string tag;
+    for (const auto &option : options) {
+        string key = option.substr(0, option.find('='));
+        if (key == "N" || key == "seed" || key == "tag" || key == "outputDir") {
+            continue;
+        }
+        string value = option.substr(option.find('=') + 1);
+        tag += (tag.empty() ? "" : "_") + key + value;
+    }
+    return tag;
+}
+
+// 在子进程中运行一个扫描点，结果以一行CSV写入管道
+void RunSweepPoint(const ScenarioConfig &config, size_t index, const string &logFileName, int fd)
+{
+    // 子进程的输出重定向到单独的日志文件，避免与其他进程交错
+    int logFd = open(logFileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (logFd >= 0) {
+        dup2(logFd, STDOUT_FILENO);
+        dup2(logFd, STDERR_FILENO);
+        close(logFd);
+    }
+    ScenarioResult result = RunScenario(config);
+    ostringstream row;
+    row << (result.ok ? "ok" : "failed") << "," << result.flows << "," << result.windows << ","
+        << result.simulatedSeconds << "," << result.wallSeconds << "," << result.runSeconds << ","
+        << result.throughput << "," << result.psr << "," << result.meanThroughput << ","
+        << result.meanPsr << "," << result.cacheHit << "," << result.setupSeconds << "," << result.events
+        << "," << result.goodput;
+    string text = row.str();
+    if (write(fd, text.data(), text.size()) < 0) {
+        cerr << "无法写回扫描点 " << index << " 的结果" << endl;
+    }
+    cout.flush();
+    cerr.flush();
+}
+
+// 在最多 jobs 个子进程中运行一组场景，每个场景结束时以其序号、结果行和子进程的资源占用调用 onDone。
+// 某个场景崩溃或超过 timeoutSeconds(0 表示不限制)只会得到一行失败记录，不影响其他场景。返回失败的场景数量
+size_t RunScenariosInWorkers(const vector<ScenarioConfig> &configs, uint32_t jobs, const string &logDir,
+                             const function<void(size_t, const string &, const struct rusage &)> &onDone,
+                             unsigned timeoutSeconds = 0)
+{
+    jobs = jobs > 0 ? jobs : max(1u, thread::hardware_concurrency());
+    fs::create_directories(logDir);
+
+    struct Worker
+    {
+        size_t index;
+        int fd;
+    };
+    map<pid_t, Worker> running;
+    size_t next = 0;
+    size_t failed = 0;
+    while (next < configs.size() || !running.empty()) {
+        while (next < configs.size() && running.size() < jobs) {
+            int fds[2];
+            if (pipe(fds) != 0) {
+                throw runtime_error("Unable to create pipe");
+            }
+            cout.flush();
+            cerr.flush();
+            pid_t pid = fork();
+            if (pid < 0) {
+                throw runtime_error("Unable to fork worker process");
+            }
+            if (pid == 0) {
+                close(fds[0]);
+                alarm(timeoutSeconds);
+                RunSweepPoint(configs[next], next, logDir + "point_" + to_string(next) + ".log", fds[1]);
+                close(fds[1]);
+                _exit(0);
+            }
+            close(fds[1]);
+            running[pid] = Worker{next, fds[0]};
+            next++;
+        }
+
+        int status = 0;
+        struct rusage usage;
+        pid_t pid = wait4(-1, &status, 0, &usage);
+        if (pid < 0) {
+            break;
+        }
+        auto it = running.find(pid);
+        if (it == running.end()) {
+            continue;
+        }
+        // 结果只有一行，子进程退出前已经全部写入管道缓冲区
+        string row;
+        char buffer[512];
+        ssize_t n;
+        while ((n = read(it->second.fd, buffer, sizeof(buffer))) > 0) {
+            row.append(buffer, n);
+        }
+        close(it->second.fd);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || row.empty()) {
+            failed++;
+            if (WIFSIGNALED(status) && WTERMSIG(status) == SIGALRM && timeoutSeconds > 0) {
+                row = "timeout";
+            } else {
+                row = WIFSIGNALED(status) ? "crashed(signal " + to_string(WTERMSIG(status)) + ")"
+                                          : "crashed(exit " + to_string(WEXITSTATUS(status)) + ")";
+            }
+        }
+        onDone(it->second.index, row, usage);
+        running.erase(it);
+    }
+    return failed;
+}
+
+// 用一组工作进程并行运行全部扫描点，结果在每个点结束时追加到汇总文件
+int RunParameterSweep(const ScenarioConfig &base, const SweepOptions &sweep)
+{
+    vector<vector<string>> points = BuildSweepPoints(sweep);
+    string outputFileName = sweep.output.empty() ? base.outputDir + "sweep_results.csv" : sweep.output;
+    fs::create_directories(fs::path(outputFileName).parent_path());
+
+    vector<ScenarioConfig> configs;
+    for (const auto &options : points) {
+        ScenarioConfig config = ApplyScenarioOptions(base, options);
+        if (config.tag.empty()) {
+            config.tag = SweepPointTag(options);
+        }
+        // 路由表文件由多个扫描点共享，在启动子进程之前创建好
+        string routingFileName = ScenarioFilePrefix(config) + "_RoutingTable.txt";
+        if (!fileExists(routingFileName)) {
+            InitRouteMatrix(routingFileName, config.N);
+        }
+        configs.push_back(config);
+    }
+
+    bool newFile = !fileExists(outputFileName);
+    ofstream output(outputFileName, ios::app);
+    if (!output.is_open()) {
+        throw runtime_error("Unable to open file " + outputFileName);
+    }
+    if (newFile) {
+        output << "index,options,status,flows,windows,simulatedSeconds,wallSeconds,runSeconds,"
+                  "throughput,psr,meanThroughput,meanPsr,cacheHit,setupSeconds,events,goodput" << endl;
+    }
+    cout << "参数扫描共 " << configs.size() << " 个场景" << endl;
+
+    size_t failed = RunScenariosInWorkers(configs, sweep.jobs, base.outputDir + "logs/",
+        [&](size_t index, const string &row, const struct rusage &) {
+            string options;
+            for (const auto &option : points[index]) {
+                options += (options.empty() ? "" : " ") + option;
+            }
+            output << index << ",\"" << options << "\"," << row << endl;
+            cout << "场景 " << index << " [" << options << "] 完成: " << row << endl;
+        });
+    output.close();
+    cout << "参数扫描结束，" << failed << " 个场景失败，结果保存在 " << outputFileName << endl;
+    return failed == 0 ? 0 : 1;
+}
+
+// 矩阵保存时保留三位小数，差值不超过舍入误差即视为一致
+const double kMatrixRoundingTolerance = 0.0015;
+
+// 用两组配置(调用者已经设置好各自的 tag)分别做一次链路测试，逐单元比较吞吐率和 psr 矩阵。
+// names 为两组配置在输出中的名称，what 为验证的名称；所有单元的差值都不超过 tolerance 时返回 0
+int CompareLinkTests(vector<ScenarioConfig> configs, const vector<string> &names, uint32_t jobs, const string &what,
+                     double tolerance = kMatrixRoundingTolerance)
+{
+    for (auto &config : configs) {
+        config.linkTest = true;
+        config.cacheDir = ""; // 两次链路测试都必须真正运行仿真
+    }
+    string routingFileName = ScenarioFilePrefix(configs[0]) + "_RoutingTable.txt";
+    if (!fileExists(routingFileName)) {
+        InitRouteMatrix(routingFileName, configs[0].N);
+    }
+    size_t failed = RunScenariosInWorkers(configs, jobs, configs[0].outputDir + "logs/",
+        [&](size_t index, const string &row, const struct rusage &) {
+            cout << configs[index].tag << " 链路测试完成: " << row << endl;
+        });
+    if (failed > 0) {
+        cerr << what << "验证失败" << endl;
+        return 1;
+    }
+
+    uint16_t N = configs[0].N;
+    uint32_t mismatches = 0;
+    for (string name : {"_tht_init_matrix.txt", "_psr_init_matrix.txt"}) {
+        Matrix<double> first = ReadMatrix<double>(ScenarioResultPrefix(configs[0]) + name);
+        Matrix<double> second = ReadMatrix<double>(ScenarioResultPrefix(configs[1]) + name);
+        double maxAbs = 0;
+        double sumAbs = 0;
+        for (uint16_t i = 0; i < N; ++i) {
+            for (uint16_t j = 0; j < N; ++j) {
+                double diff = fabs(second.At(i, j) - first.At(i, j));
+                maxAbs = max(maxAbs, diff);
+                sumAbs += diff;
+                if (diff > tolerance) {
+                    mismatches++;
+                    cout << "  " << name << " (" << i << ", " << j << "): " << names[0] << " " << first[i][j]
+                         << ", " << names[1] << " " << second[i][j] << endl;
+                }
+            }
+        }
+        cout << name << " 平均绝对差 " << (N > 1 ? sumAbs / (double(N) * (N - 1)) : 0) << ", 最大绝对差 " << maxAbs
+             << endl;
+    }
+    cout << names[1] << " 与 " << names[0] << " 的结果(容差 " << tolerance << ")"
+         << (mismatches == 0 ? "一致" : "不一致，共 " + to_string(mismatches) + " 个单元") << endl;
+    return mismatches == 0 ? 0 : 1;
+}
+
+// 分别用 waveform 和 psd 两种干扰模式做一次链路测试。psd 模式把持续发送(DutyCycle=1)的波形折算为噪声，
+// 两种模式的事件顺序不同，吞吐率(Mbps)和 psr(百分点)只能在 tolerance 以内一致
+int RunInterferenceValidation(const ScenarioConfig &base, uint32_t jobs, double tolerance)
+{
+    vector<ScenarioConfig> configs;
+    for (string mode : {"waveform", "psd"}) {
+        ScenarioConfig config = base;
+        config.interferenceMode = mode;
+        config.tag = base.tag.empty() ? mode : base.tag + "_" + mode;
+        configs.push_back(config);
+    }
+    return CompareLinkTests(configs, {"waveform", "psd"}, jobs, "干扰模式", tolerance);
+}
+
+// 分别用 FlowMonitor 和计数探针做一次链路测试，两者的吞吐率和 psr 矩阵应当一致
+int RunFlowProbeValidation(const ScenarioConfig &base, uint32_t jobs)
+{
+    vector<ScenarioConfig> configs;
+    for (bool flowProbe : {false, true}) {
+        ScenarioConfig config = base;
+        config.flowProbe = flowProbe;
+        string name = flowProbe ? "probe" : "flowmonitor";
+        config.tag = base.tag.empty() ? name : base.tag + "_" + name;
+        configs.push_back(config);
+    }
+    return CompareLinkTests(configs, {"FlowMonitor", "计数探针"}, jobs, "计数探针");
+}
+
+// 分别用 multi 和 single 频谱信道做一次链路测试。两者的干扰功率谱密度相同，只是 single 信道不转换频谱模型，
+// 吞吐率和 psr 矩阵应当一致
+int RunSpectrumChannelValidation(const ScenarioConfig &base, uint32_t jobs)
+{
+    vector<ScenarioConfig> configs;
+    for (string channel : {"multi", "single"}) {
+        ScenarioConfig config = base;
+        config.spectrumChannel = channel;
+        config.tag = base.tag.empty() ? channel : base.tag + "_" + channel;
+        configs.push_back(config);
+    }
+    return CompareLinkTests(configs, {"multi", "single"}, jobs, "频谱信道");
+}
+
+// 分别用正常模式和快进模式做一次链路测试，快进模式要求两者的吞吐率和 psr 矩阵一致
+int RunFastForwardValidation(const ScenarioConfig &base, uint32_t jobs)
+{
+    vector<ScenarioConfig> configs;
+    for (bool fastForward : {false, true}) {
+        ScenarioConfig config = base;
+        config.fastForward = fastForward;
+        string name = fastForward ? "fastforward" : "normal";
+        config.tag = base.tag.empty() ? name : base.tag + "_" + name;
+        configs.push_back(config);
+    }
+    return CompareLinkTests(configs, {"正常模式", "快进模式"}, jobs, "快进模式");
+}
+
+// RunSweepPoint 写出的结果行中可以比较的指标所在的列
+static const map<string, size_t> kResultMetricColumns = {
+    {"throughput", 6}, {"psr", 7}, {"meanThroughput", 8}, {"meanPsr", 9}, {"goodput", 13},
+};
+
+// 从结果行中取出指标的值，结果行的状态不是 ok 时返回 false
+bool ParseResultMetric(const string &row, const string &metric, double *value)
+{
+    vector<string> fields = SplitString(row, ',');
+    auto it = kResultMetricColumns.find(metric);
+    if (it == kResultMetricColumns.end() || fields.empty() || fields[0] != "ok" || fields.size() <= it->second) {
+        return false;
+    }
+    *value = stod(fields[it->second]);
+    return true;
+}
+
+// 公共随机数(CRN)重复仿真：第 r 次重复中各个干扰功率的场景使用相同的 seed 和 run，
+// 节点位置、MAC 退避和 ARP 等随机数都相同，配对差值只反映干扰功率的影响。
+// 每批并行运行若干次重复，每个功率与基准功率的配对差值的置信区间半宽都不超过 crnPrecision
+// (且至少 crnMinReps 次)后停止，最多 crnMaxReps 次。某次重复中任何一个场景失败时整次重复不计入
+int RunCrnReplications(const ScenarioConfig &base, const SweepOptions &sweep)
+{
+    vector<string> powers = SplitString(sweep.crnPowers, ',');
+    if (powers.size() < 2 || kResultMetricColumns.count(sweep.crnMetric) == 0) {
+        cerr << "公共随机数重复仿真至少需要两个干扰功率，指标只能为 throughput、psr、meanThroughput、meanPsr 或 goodput"
+             << endl;
+        return 1;
+    }
+    if (sweep.crnMaxReps < 2 || sweep.crnMinReps > sweep.crnMaxReps) {
+        cerr << "公共随机数重复仿真的最多重复次数不能小于2，也不能小于最少重复次数" << endl;
+        return 1;
+    }
+    string routingFileName = ScenarioFilePrefix(base) + "_RoutingTable.txt";
+    if (!fileExists(routingFileName)) {
+        InitRouteMatrix(routingFileName, base.N);
+    }
+    string outputFileName = sweep.output.empty() ? base.outputDir + "crn_results.csv" : sweep.output;
+    // 汇总文件与结果文件放在同一目录，指定 --output 时在其文件名后加 _summary，避免多次研究互相覆盖
+    fs::path outputPath(outputFileName);
+    string summaryFileName = sweep.output.empty()
+        ? base.outputDir + "crn_summary.csv"
+        : (outputPath.parent_path() / (outputPath.stem().string() + "_summary" + outputPath.extension().string()))
+              .string();
+    fs::create_directories(outputPath.parent_path());
+    ofstream output(outputFileName);
+    if (!output.is_open()) {
+        throw runtime_error("Unable to open file " + outputFileName);
+    }
+    output << "run,power,status," << sweep.crnMetric << endl;
+
+    size_t P = powers.size();
+    vector<BatchMeans> arms(P); // 每个功率的指标
+    vector<BatchMeans> diffs(P); // 每个功率减去基准功率的配对差值，diffs[0] 不使用
+    // 每批的重复次数使全部进程都有场景可运行
+    uint32_t jobs = sweep.jobs > 0 ? sweep.jobs : max(1u, thread::hardware_concurrency());
+    uint32_t batch = max<uint32_t>(1, jobs / P);
+    uint32_t nextRun = 1;
+    uint32_t failedReps = 0;
+    auto converged = [&]() {
+        if (diffs[1].n < max(sweep.crnMinReps, 2u)) {
+            return false;
+        }
+        for (size_t p = 1; p < P; ++p) {
+            if (diffs[p].HalfWidth() > sweep.crnPrecision) {
+                return false;
+            }
+        }
+        return true;
+    };
+    cout << "公共随机数重复仿真: 干扰功率 " << sweep.crnPowers << ", 指标 " << sweep.crnMetric << ", 目标半宽 "
+         << sweep.crnPrecision << endl;
+    while (nextRun <= sweep.crnMaxReps && !converged()) {
+        uint32_t reps = min(batch, sweep.crnMaxReps - nextRun + 1);
+        vector<ScenarioConfig> configs;
+        for (uint32_t r = 0; r < reps; ++r) {
+            for (const auto &power : powers) {
+                ScenarioConfig config = ApplyScenarioOptions(base, {"power=" + power});
+                config.run = nextRun + r;
+                // 每次重复的 tag 不同，各自没有链路测试结果；单流指标只取决于本次测量的链路，
+                // 不关闭自动链路测试的话每次重复都要先测量全部 N(N-1) 条链路。
+                // 干扰功率和 run 都会改变链路测试结果，路由优化仍然在每次重复中各做一次链路测试
+                config.autoLinkTest = false;
+                config.tag = (base.tag.empty() ? "" : base.tag + "_") + "power" + power + "_run" +
+                             to_string(config.run);
+                configs.push_back(config);
+            }
+        }
+        vector<string> rows(configs.size());
+        RunScenariosInWorkers(configs, jobs, base.outputDir + "logs/",
+            [&](size_t index, const string &row, const struct rusage &) { rows[index] = row; });
+
+        for (uint32_t r = 0; r < reps; ++r) {
+            vector<double> values(P);
+            bool ok = true;
+            for (size_t p = 0; p < P; ++p) {
+                const string &row = rows[r * P + p];
+                bool valid = ParseResultMetric(row, sweep.crnMetric, &values[p]);
+                ok = ok && valid;
+                output << nextRun + r << "," << powers[p] << "," << (valid ? "ok" : row.substr(0, row.find(',')))
+                       << "," << (valid ? values[p] : 0) << endl;
+            }
+            if (!ok) {
+                failedReps++;
+                continue;
+            }
+            for (size_t p = 0; p < P; ++p) {
+                arms[p].Add(values[p]);
+                if (p > 0) {
+                    diffs[p].Add(values[p] - values[0]);
+                }
+            }
+        }
+        nextRun += reps;
+        cout << "已完成 " << diffs[1].n << " 次重复:";
+        for (size_t p = 1; p < P; ++p) {
+            cout << " power " << powers[p] << "-" << powers[0] << " = " << diffs[p].Mean() << " ± "
+                 << diffs[p].HalfWidth();
+        }
+        cout << endl;
+    }
+    output.close();
+
+    // 与独立抽样比较：同样次数的独立重复，差值的方差为两个功率的方差之和
+    ofstream summary(summaryFileName);
+    if (!summary.is_open()) {
+        throw runtime_error("Unable to open file " + summaryFileName);
+    }
+    summary << "power,basePower,reps,meanDiff,halfWidth,independentHalfWidth,varianceReduction,"
+               "independentRepsNeeded" << endl;
+    for (size_t p = 1; p < P; ++p) {
+        uint32_t n = diffs[p].n;
+        double independentVariance = arms[p].Variance() + arms[0].Variance();
+        double independentHalfWidth = n < 2 ? numeric_limits<double>::infinity()
+                                            : StudentT95(n - 1) * sqrt(independentVariance / n);
+        double reduction = diffs[p].Variance() > 0 ? independentVariance / diffs[p].Variance() : 0;
+        summary << powers[p] << "," << powers[0] << "," << n << "," << diffs[p].Mean() << "," << diffs[p].HalfWidth()
+                << "," << independentHalfWidth << "," << reduction << "," << ceil(n * reduction) << endl;
+        cout << "power " << powers[p] << " 相对 " << powers[0] << ": " << sweep.crnMetric << " 差值 "
+             << diffs[p].Mean() << " ± " << diffs[p].HalfWidth() << " (95% 置信区间, " << n
+             << " 次重复); 独立抽样的半宽为 " << independentHalfWidth << ", 方差缩小 " << reduction
+             << " 倍, 约需 " << ceil(n * reduction) << " 次独立重复" << endl;
+    }
+    cout << (converged() ? "已达到目标精度" : "达到最多重复次数仍未满足目标精度") << ", " << failedReps
+         << " 次重复因场景失败未计入; 每次仿真的结果保存在 " << outputFileName << ", 汇总保存在 "
+         << summaryFileName << endl;
+    return diffs[1].n >= 2 ? 0 : 1;
+}
+
+#endif // PARAMETER_SWEEP_H
@@ -0,0 +1,252 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include "UtilityFunctions.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+// 64 位 FNV-1a 哈希，用于由场景配置生成缓存键
+uint64_t Fnv1a64(const std::string &text, uint64_t hash = 14695981039346656037ULL)
+{
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// 一次仿真中测量的单元 (i, j)
+struct CachedCell
+{
+    uint16_t i = 0;
+    uint16_t j = 0;
+    double throughput = 0;
+    double psr = 0;
+    double throughputCi = 0; // 自适应测量的置信区间半宽，非自适应测量为 0
+    double psrCi = 0;
+    double duration = 0;
+};
+
+// 缓存的仿真结果：只保存本次实际测量的单元，命中时覆盖到已有的矩阵上
+struct CachedResult
+{
+    uint32_t flows = 0;
+    uint32_t windows = 0;
+    double simulatedSeconds = 0;
+    double runSeconds = 0; // 原始仿真中 Simulator::Run 的耗时
+    std::vector<CachedCell> cells;
+};
+
+// 按场景配置哈希寻址的结果缓存，目录结构为 <dir>/<哈希>/result.txt。
+// 条目先写入临时目录再整体 rename，读者只会看到完整的条目，多个扫描进程可以共享同一目录；
+// 统计量的更新和按大小淘汰都在 <dir>/.lock 上的文件锁内进行。
+// 命中时更新 result.txt 的修改时间，淘汰时先删除最久未使用的条目
+class ResultCache
+{
+  public:
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t stores = 0;
+        uint64_t evictions = 0;
+        uint64_t entries = 0;
+        uint64_t bytes = 0;
+    };
+
+    // dir 为空表示不使用缓存；maxBytes 为 0 表示不限制大小
+    ResultCache(const std::string &dir, uint64_t maxBytes)
+        : m_dir(dir),
+          m_maxBytes(maxBytes)
+    {
+        if (Enabled()) {
+            fs::create_directories(m_dir);
+        }
+    }
+
+    bool Enabled() const
+    {
+        return !m_dir.empty();
+    }
+
+    static std::string KeyName(uint64_t key)
+    {
+        char name[17];
+        snprintf(name, sizeof(name), "%016llx", (unsigned long long)key);
+        return name;
+    }
+
+    bool Lookup(uint64_t key, CachedResult *result)
+    {
+        fs::path file = m_dir / KeyName(key) / "result.txt";
+        std::ifstream input(file);
+        bool hit = input.is_open() && Parse(input, result);
+        if (hit) {
+            std::error_code ec; // 条目可能刚被其他进程淘汰，忽略错误
+            fs::last_write_time(file, fs::file_time_type::clock::now(), ec);
+        }
+        UpdateStats(hit ? 1 : 0, hit ? 0 : 1, 0, 0);
+        return hit;
+    }
+
+    void Store(uint64_t key, const CachedResult &result)
+    {
+        fs::path entry = m_dir / KeyName(key);
+        fs::path tmp = m_dir / (".tmp-" + KeyName(key) + "-" + std::to_string(getpid()));
+        fs::remove_all(tmp);
+        fs::create_directories(tmp);
+        {
+            std::ofstream output(tmp / "result.txt");
+            output << std::setprecision(17);
+            output << "flows " << result.flows << "\n"
+                   << "windows " << result.windows << "\n"
+                   << "simulatedSeconds " << result.simulatedSeconds << "\n"
+                   << "runSeconds " << result.runSeconds << "\n"
+                   << "cells " << result.cells.size() << "\n";
+            for (const auto &cell : result.cells) {
+                output << cell.i << " " << cell.j << " " << cell.throughput << " " << cell.psr << " "
+                       << cell.throughputCi << " " << cell.psrCi << " " << cell.duration << "\n";
+            }
+            if (!output) {
+                fs::remove_all(tmp);
+                throw std::runtime_error("Unable to write cache entry " + tmp.string());
+            }
+        }
+        // 目标已存在时说明其他进程已经写入了相同的结果，rename 失败即可丢弃本次结果
+        if (std::rename(tmp.c_str(), entry.c_str()) != 0) {
+            fs::remove_all(tmp);
+            return;
+        }
+        UpdateStats(0, 0, 1, 0);
+        if (m_maxBytes > 0) {
+            Evict();
+        }
+    }
+
+    Stats GetStats()
+    {
+        int fd = Lock();
+        Stats stats = ReadStats();
+        flock(fd, LOCK_UN);
+        close(fd);
+        for (const auto &entry : ListEntries()) {
+            stats.entries++;
+            stats.bytes += entry.second;
+        }
+        return stats;
+    }
+
+  private:
+    static bool Parse(std::istream &input, CachedResult *result)
+    {
+        std::string key;
+        size_t cells = 0;
+        if (!(input >> key >> result->flows >> key >> result->windows >> key >>
+              result->simulatedSeconds >> key >> result->runSeconds >> key >> cells)) {
+            return false;
+        }
+        result->cells.resize(cells);
+        for (auto &cell : result->cells) {
+            if (!(input >> cell.i >> cell.j >> cell.throughput >> cell.psr >> cell.throughputCi >>
+                  cell.psrCi >> cell.duration)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int Lock()
+    {
+        int fd = open((m_dir / ".lock").c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0 || flock(fd, LOCK_EX) != 0) {
+            throw std::runtime_error("Unable to lock cache directory " + m_dir.string());
+        }
+        return fd;
+    }
+
+    // 调用者需要持有锁
+    Stats ReadStats()
+    {
+        Stats stats;
+        std::ifstream input(m_dir / "stats.txt");
+        std::string key;
+        input >> key >> stats.hits >> key >> stats.misses >> key >> stats.stores >> key >> stats.evictions;
+        return stats;
+    }
+
+    void UpdateStats(uint64_t hits, uint64_t misses, uint64_t stores, uint64_t evictions)
+    {
+        int fd = Lock();
+        Stats stats = ReadStats();
+        stats.hits += hits;
+        stats.misses += misses;
+        stats.stores += stores;
+        stats.evictions += evictions;
+        std::ofstream output(m_dir / "stats.txt", std::ios::trunc);
+        output << "hits " << stats.hits << "\nmisses " << stats.misses << "\nstores " << stats.stores
+               << "\nevictions " << stats.evictions << "\n";
+        output.close();
+        flock(fd, LOCK_UN);
+        close(fd);
+    }
+
+    // 所有完整条目及其大小，跳过临时目录和锁文件
+    std::vector<std::pair<fs::path, uint64_t>> ListEntries()
+    {
+        std::vector<std::pair<fs::path, uint64_t>> entries;
+        std::error_code ec;
+        for (const auto &dir : fs::directory_iterator(m_dir, ec)) {
+            if (!dir.is_directory(ec) || dir.path().filename().string()[0] == '.') {
+                continue;
+            }
+            uint64_t bytes = 0;
+            for (const auto &file : fs::recursive_directory_iterator(dir.path(), ec)) {
+                if (file.is_regular_file(ec)) {
+                    bytes += file.file_size(ec);
+                }
+            }
+            entries.push_back(std::make_pair(dir.path(), bytes));
+        }
+        return entries;
+    }
+
+    void Evict()
+    {
+        int fd = Lock();
+        auto entries = ListEntries();
+        uint64_t total = 0;
+        std::vector<std::pair<fs::file_time_type, size_t>> order;
+        for (size_t k = 0; k < entries.size(); ++k) {
+            total += entries[k].second;
+            std::error_code ec;
+            order.push_back(std::make_pair(fs::last_write_time(entries[k].first / "result.txt", ec), k));
+        }
+        std::sort(order.begin(), order.end());
+        uint64_t evicted = 0;
+        for (size_t k = 0; k < order.size() && total > m_maxBytes; ++k) {
+            const auto &entry = entries[order[k].second];
+            // 先改名再删除，其他进程不会读到删除了一半的条目
+            fs::path trash = m_dir / (".evict-" + entry.first.filename().string() + "-" + std::to_string(getpid()));
+            if (std::rename(entry.first.c_str(), trash.c_str()) == 0) {
+                fs::remove_all(trash);
+                total -= entry.second;
+                evicted++;
+            }
+        }
+        flock(fd, LOCK_UN);
+        close(fd);
+        if (evicted > 0) {
+            UpdateStats(0, 0, 0, evicted);
+        }
+    }
+
+    fs::path m_dir;
+    uint64_t m_maxBytes;
+};
+
+#endif // RESULT_CACHE_H
@@ -0,0 +1,369 @@
+#ifndef ROUTE_OPTIMIZER_H
+#define ROUTE_OPTIMIZER_H
+
+#include "FlowStatsIndex.h"
+#include "LinkScheduler.h"
+
+#include <functional>
+#include <limits>
+
+// 按下一跳矩阵从 source 走到 destination 经过的节点序列，无路由或出现环路时以 -1 结尾
+std::vector<int> RoutePath(const Matrix<int> &routingTable, int source, int destination)
+{
+    std::vector<int> path = {source};
+    std::vector<bool> visited(routingTable.Rows(), false);
+    int current = source;
+    while (current != destination) {
+        visited[current] = true;
+        int next = routingTable[current][destination];
+        if (next < 0 || next >= int(routingTable.Rows()) || visited[next]) {
+            path.push_back(-1);
+            break;
+        }
+        path.push_back(next);
+        current = next;
+    }
+    return path;
+}
+
+// 两个路由表之间跳序列发生变化的全部源/汇节点对
+std::vector<Link> FindChangedRoutes(const Matrix<int> &oldTable, const Matrix<int> &newTable)
+{
+    std::vector<Link> changed;
+    for (uint16_t j = 0; j < newTable.Rows(); ++j) {
+        for (uint16_t i = 0; i < newTable.Rows(); ++i) {
+            if (i != j && RoutePath(oldTable, i, j) != RoutePath(newTable, i, j)) {
+                changed.push_back(Link(i, j));
+            }
+        }
+    }
+    return changed;
+}
+
+// 路由度量
+enum RouteMetric
+{
+    ROUTE_WIDEST, // 最宽路径：最大化路径上最小的链路吞吐率
+    ROUTE_ETX,    // 最小期望传输次数：链路 ETX = 1 / (正向psr * 反向psr)
+};
+
+RouteMetric ParseRouteMetric(const std::string &metric)
+{
+    if (metric == "widest") {
+        return ROUTE_WIDEST;
+    }
+    if (metric == "etx") {
+        return ROUTE_ETX;
+    }
+    throw std::runtime_error("Unknown route metric " + metric + " (expected widest or etx)");
+}
+
+// 以 capacity[i][j](链路 i->j 的吞吐率)计算最宽路径路由，返回下一跳矩阵。
+// 对每个目的节点做一次 Dijkstra，瓶颈相同时选择跳数较少的路径；不可达时直接发送到目的节点
+Matrix<int> ComputeWidestPathRoutes(const Matrix<double> &capacity)
+{
+    size_t n = capacity.Rows();
+    Matrix<int> routes(n, n, -1);
+    for (size_t d = 0; d < n; ++d) {
+        std::vector<double> width(n, 0);
+        std::vector<uint32_t> hops(n, std::numeric_limits<uint32_t>::max());
+        std::vector<bool> done(n, false);
+        width[d] = std::numeric_limits<double>::infinity();
+        hops[d] = 0;
+        for (size_t step = 0; step < n; ++step) {
+            int u = -1;
+            for (size_t v = 0; v < n; ++v) {
+                if (!done[v] && width[v] > 0 &&
+                    (u < 0 || width[v] > width[u] || (width[v] == width[u] && hops[v] < hops[u]))) {
+                    u = v;
+                }
+            }
+            if (u < 0) {
+                break;
+            }
+            done[u] = true;
+            for (size_t v = 0; v < n; ++v) {
+                if (done[v] || capacity[v][u] <= 0) {
+                    continue;
+                }
+                double candidate = std::min(capacity[v][u], width[u]);
+                if (candidate > width[v] || (candidate == width[v] && hops[u] + 1 < hops[v])) {
+                    width[v] = candidate;
+                    hops[v] = hops[u] + 1;
+                    routes[v][d] = u;
+                }
+            }
+        }
+        for (size_t i = 0; i < n; ++i) {
+            if (i != d && routes[i][d] < 0) {
+                routes[i][d] = d;
+            }
+        }
+    }
+    return routes;
+}
+
+// 以 delivery[i][j](链路 i->j 的分组投递率，0~1)计算 ETX 最短路径路由，返回下一跳矩阵。
+// 正向或反向投递率低于 minDelivery 的链路不参与路由；不可达时直接发送到目的节点
+Matrix<int> ComputeEtxRoutes(const Matrix<double> &delivery, double minDelivery = 0.1)
+{
+    size_t n = delivery.Rows();
+    const double inf = std::numeric_limits<double>::infinity();
+    Matrix<int> routes(n, n, -1);
+    for (size_t d = 0; d < n; ++d) {
+        std::vector<double> cost(n, inf);
+        std::vector<bool> done(n, false);
+        cost[d] = 0;
+        for (size_t step = 0; step < n; ++step) {
+            int u = -1;
+            for (size_t v = 0; v < n; ++v) {
+                if (!done[v] && cost[v] < inf && (u < 0 || cost[v] < cost[u])) {
+                    u = v;
+                }
+            }
+            if (u < 0) {
+                break;
+            }
+            done[u] = true;
+            for (size_t v = 0; v < n; ++v) {
+                if (done[v] || delivery[v][u] < minDelivery || delivery[u][v] < minDelivery) {
+                    continue;
+                }
+                double candidate = cost[u] + 1.0 / (delivery[v][u] * delivery[u][v]);
+                if (candidate < cost[v]) {
+                    cost[v] = candidate;
+                    routes[v][d] = u;
+                }
+            }
+        }
+        for (size_t i = 0; i < n; ++i) {
+            if (i != d && routes[i][d] < 0) {
+                routes[i][d] = d;
+            }
+        }
+    }
+    return routes;
+}
+
+// 仿真内的路由优化：每一轮根据链路度量计算路由并安装，逐个测量各源/汇节点对的端到端结果。
+// 端到端结果低于按链路度量预测的值时(例如多跳路径的跳间干扰)，按比例调低路径上各链路的度量，
+// 下一轮据此重新选路。每轮的路由和结果都写入文件，最后一个节点对测量结束后停止仿真
+class RouteOptimizer
+{
+  public:
+    struct Options
+    {
+        RouteMetric metric = ROUTE_WIDEST;
+        uint32_t rounds = 1;
+        double damping = 0.5;  // 每轮对链路度量的修正幅度，0 表示不修正
+        double duration = 1;   // 每个节点对的测量时间
+        double gap = 1;        // 两次测量之间的间隔
+        std::string outputPrefix;
+        bool binaryMatrices = false;
+        uint32_t seed = 0;
+    };
+    // 在当前时刻安装下一跳矩阵
+    typedef std::function<void(const Matrix<int> &)> RouteInstaller;
+    // 在当前时刻创建一条持续 duration 秒的 source -> sink 流，返回 FlowStatsIndex 句柄
+    typedef std::function<uint32_t(uint16_t, uint16_t, double)> FlowFactory;
+    // 快进模式下控制干扰节点：openWindow(delay) 表示 delay 秒后开始测量一个节点对，closeWindow() 在读取结果后调用
+    typedef std::function<void(double)> WindowOpener;
+    typedef std::function<void()> WindowCloser;
+
+    RouteOptimizer(const Options &options, FlowStatsIndex *flowIndex, const std::vector<Link> &pairs)
+        : m_options(options),
+          m_flowIndex(flowIndex),
+          m_pairs(pairs)
+    {
+    }
+
+    // 在 startTime 读取链路测试的吞吐率和psr矩阵作为初始度量并开始第一轮，
+    // 同一次仿真中先做链路测试时，矩阵在此之前已经被填好
+    void Start(double startTime,
+               const Matrix<double> *throughput,
+               const Matrix<double> *psr,
+               RouteInstaller installRoutes,
+               FlowFactory createFlow)
+    {
+        m_linkThroughput = throughput;
+        m_linkPsr = psr;
+        m_installRoutes = installRoutes;
+        m_createFlow = createFlow;
+        if (m_pairs.empty() || m_options.rounds == 0) {
+            Simulator::Stop(Seconds(startTime));
+            return;
+        }
+        Simulator::Schedule(Seconds(startTime), &RouteOptimizer::Initialize, this);
+        OpenWindow(startTime); // 第一轮的第一个节点对
+    }
+
+    // 节点对的测量时刻在仿真过程中才确定，由优化器在每次测量开始之前通知打开干扰节点
+    void SetWindowGate(WindowOpener openWindow, WindowCloser closeWindow)
+    {
+        m_openWindow = openWindow;
+        m_closeWindow = closeWindow;
+    }
+
+    uint32_t GetFlows() const
+    {
+        return m_flows;
+    }
+
+    uint32_t GetRounds() const
+    {
+        return m_round;
+    }
+
+  private:
+    void Initialize()
+    {
+        size_t n = m_linkThroughput->Rows();
+        m_capacity = m_linkThroughput->Clone();
+        m_delivery = Matrix<double>(n, n, 0);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                m_delivery[i][j] = (*m_linkPsr)[i][j] / 100;
+            }
+        }
+        m_summary.open(m_options.outputPrefix + "_opt_summary.csv");
+        m_summary << "round,metric,pairs,changedPairs,meanThroughput,meanPsr" << std::endl;
+        StartRound();
+    }
+
+    void StartRound()
+    {
+        Matrix<int> routes = m_options.metric == ROUTE_WIDEST ? ComputeWidestPathRoutes(m_capacity)
+                                                              : ComputeEtxRoutes(m_delivery);
+        m_changedPairs = m_routes.Empty() ? m_pairs.size() : FindChangedRoutes(m_routes, routes).size();
+        m_routes = std::move(routes);
+        m_installRoutes(m_routes);
+        size_t n = m_routes.Rows();
+        m_throughput = Matrix<double>(n, n, 0);
+        m_psr = Matrix<double>(n, n, 0);
+        // 节点对依次测量，互不干扰。第一个节点对在本轮开始时立即测量，由安排本轮的一方提前打开干扰节点
+        for (size_t k = 0; k < m_pairs.size(); ++k) {
+            Simulator::Schedule(Seconds(k * (m_options.duration + m_options.gap)),
+                                &RouteOptimizer::StartPair, this, k);
+            if (k > 0) {
+                OpenWindow(k * (m_options.duration + m_options.gap));
+            }
+        }
+    }
+
+    void StartPair(size_t k)
+    {
+        uint32_t handle = m_createFlow(m_pairs[k].first, m_pairs[k].second, m_options.duration);
+        m_flows++;
+        Simulator::Schedule(Seconds(m_options.duration + m_options.gap / 2),
+                            &RouteOptimizer::CollectPair, this, k, handle);
+    }
+
+    void CollectPair(size_t k, uint32_t handle)
+    {
+        FlowSample sample = m_flowIndex->Cumulative(handle);
+        uint16_t s = m_pairs[k].first;
+        uint16_t d = m_pairs[k].second;
+        m_throughput[s][d] = sample.valid ? sample.throughput : 0.0;
+        m_psr[s][d] = sample.valid ? sample.psr : 0.0;
+        if (m_closeWindow) {
+            m_closeWindow();
+        }
+        if (k + 1 == m_pairs.size()) {
+            EndRound();
+        }
+    }
+
+    void EndRound()
+    {
+        std::string prefix = m_options.outputPrefix + "_opt_round" + std::to_string(m_round);
+        uint32_t n = m_routes.Rows();
+        SaveMatrix(m_routes, prefix + "_RoutingTable.txt", m_options.binaryMatrices, n, m_options.seed);
+        SaveMatrix(m_throughput, prefix + "_tht_matrix.txt", m_options.binaryMatrices, n, m_options.seed);
+        SaveMatrix(m_psr, prefix + "_psr_matrix.txt", m_options.binaryMatrices, n, m_options.seed);
+
+        double throughputSum = 0;
+        double psrSum = 0;
+        for (const auto &pair : m_pairs) {
+            throughputSum += m_throughput[pair.first][pair.second];
+            psrSum += m_psr[pair.first][pair.second];
+            Feedback(pair.first, pair.second);
+        }
+        double meanThroughput = throughputSum / m_pairs.size();
+        double meanPsr = psrSum / m_pairs.size();
+        m_summary << m_round << "," << (m_options.metric == ROUTE_WIDEST ? "widest" : "etx") << ","
+                  << m_pairs.size() << "," << m_changedPairs << "," << meanThroughput << "," << meanPsr
+                  << std::endl;
+        std::cout << "路由优化第 " << m_round << " 轮: " << m_changedPairs << " 个节点对的路径改变, 平均吞吐率 "
+                  << meanThroughput << " Mbps, 平均psr " << meanPsr << "%" << std::endl;
+
+        double score = m_options.metric == ROUTE_WIDEST ? meanThroughput : meanPsr;
+        if (m_round == 0 || score > m_bestScore) {
+            m_bestScore = score;
+            SaveMatrix(m_routes, m_options.outputPrefix + "_opt_best_RoutingTable.txt",
+                       m_options.binaryMatrices, n, m_options.seed);
+        }
+
+        m_round++;
+        if (m_round < m_options.rounds) {
+            Simulator::Schedule(Seconds(m_options.gap / 2), &RouteOptimizer::StartRound, this);
+            OpenWindow(m_options.gap / 2); // 下一轮的第一个节点对
+        } else {
+            m_summary.close();
+            Simulator::Stop(Seconds(m_options.gap / 2));
+        }
+    }
+
+    void OpenWindow(double delay)
+    {
+        if (m_openWindow) {
+            m_openWindow(delay);
+        }
+    }
+
+    // 端到端结果与按链路度量预测的值之比 r 小于 1 时，路径上每条链路的度量乘以 1 - damping * (1 - r)
+    void Feedback(uint16_t source, uint16_t destination)
+    {
+        std::vector<int> path = RoutePath(m_routes, source, destination);
+        if (path.back() < 0) {
+            return;
+        }
+        Matrix<double> &metric = m_options.metric == ROUTE_WIDEST ? m_capacity : m_delivery;
+        double predicted = m_options.metric == ROUTE_WIDEST ? std::numeric_limits<double>::infinity() : 1.0;
+        for (size_t h = 0; h + 1 < path.size(); ++h) {
+            double link = metric[path[h]][path[h + 1]];
+            predicted = m_options.metric == ROUTE_WIDEST ? std::min(predicted, link) : predicted * link;
+        }
+        double measured = m_options.metric == ROUTE_WIDEST ? m_throughput[source][destination]
+                                                           : m_psr[source][destination] / 100;
+        if (predicted <= 0 || measured >= predicted) {
+            return;
+        }
+        double scale = 1 - m_options.damping * (1 - measured / predicted);
+        for (size_t h = 0; h + 1 < path.size(); ++h) {
+            metric[path[h]][path[h + 1]] *= scale;
+        }
+    }
+
+    Options m_options;
+    FlowStatsIndex *m_flowIndex;
+    std::vector<Link> m_pairs;
+    const Matrix<double> *m_linkThroughput = nullptr;
+    const Matrix<double> *m_linkPsr = nullptr;
+    RouteInstaller m_installRoutes;
+    FlowFactory m_createFlow;
+    WindowOpener m_openWindow;
+    WindowCloser m_closeWindow;
+
+    Matrix<double> m_capacity; // 当前的链路吞吐率度量
+    Matrix<double> m_delivery; // 当前的链路投递率度量
+    Matrix<int> m_routes;
+    Matrix<double> m_throughput; // 本轮的端到端测量结果
+    Matrix<double> m_psr;
+    std::ofstream m_summary;
+    size_t m_changedPairs = 0;
+    uint32_t m_round = 0;
+    uint32_t m_flows = 0;
+    double m_bestScore = 0;
+};
+
+#endif // ROUTE_OPTIMIZER_H
@@ -0,0 +1,401 @@
+#ifndef SCENARIO_PROFILER_H
+#define SCENARIO_PROFILER_H
+
+#include "UtilityFunctions.h"
+
+#include "ns3/event-impl.h"
+#include "ns3/map-scheduler.h"
+#include "ns3/scheduler.h"
+
+#include <chrono>
+#include <cxxabi.h>
+#include <map>
+#include <typeindex>
+#include <unordered_map>
+
+namespace ns3
+{
+
+// 包装默认的 MapScheduler，统计每个被执行事件的类型和上下文(节点ID)，
+// 并按仿真时间间隔采样事件队列的长度。只在 profile 模式下通过 Simulator::SetScheduler 安装
+class ProfilingScheduler : public Scheduler
+{
+  public:
+    static TypeId GetTypeId()
+    {
+        static TypeId tid = TypeId("ns3::ProfilingScheduler")
+                                .SetParent<Scheduler>()
+                                .SetGroupName("Core")
+                                .AddConstructor<ProfilingScheduler>();
+        return tid;
+    }
+
+    ProfilingScheduler()
+        : m_inner(CreateObject<MapScheduler>())
+    {
+        s_current = this;
+    }
+
+    ~ProfilingScheduler() override
+    {
+        if (s_current == this) {
+            s_current = nullptr;
+        }
+    }
+
+    // 当前仿真器使用的实例，Simulator 不提供获取调度器的接口
+    static ProfilingScheduler *GetCurrent()
+    {
+        return s_current;
+    }
+
+    void Insert(const Event &ev) override
+    {
+        m_inner->Insert(ev);
+        m_depth++;
+        m_maxDepth = std::max(m_maxDepth, m_depth);
+    }
+
+    bool IsEmpty() const override
+    {
+        return m_inner->IsEmpty();
+    }
+
+    Event PeekNext() const override
+    {
+        return m_inner->PeekNext();
+    }
+
+    Event RemoveNext() override
+    {
+        Event ev = m_inner->RemoveNext();
+        m_depth--;
+        if (!m_recording) {
+            return ev;
+        }
+        m_executed++;
+        if (ev.impl->IsCancelled()) {
+            m_cancelled++; // 已取消的事件同样会出队，但不会执行任何操作
+        } else {
+            m_byType[std::type_index(typeid(*ev.impl))]++;
+        }
+        m_byContext[ev.key.m_context]++;
+        if (ev.key.m_ts >= m_nextSampleTs) {
+            m_depthSamples.push_back(std::make_pair(ev.key.m_ts, m_depth));
+            m_nextSampleTs = ev.key.m_ts + m_sampleStep;
+        }
+        return ev;
+    }
+
+    void Remove(const Event &ev) override
+    {
+        m_inner->Remove(ev);
+        m_depth--;
+    }
+
+    void SetSampleInterval(Time interval)
+    {
+        m_sampleStep = std::max<int64_t>(1, interval.GetTimeStep());
+    }
+
+    // Simulator::Destroy 清空队列时的出队不计入统计
+    void StopRecording()
+    {
+        m_recording = false;
+    }
+
+    uint64_t GetExecuted() const
+    {
+        return m_executed;
+    }
+
+    uint64_t GetCancelled() const
+    {
+        return m_cancelled;
+    }
+
+    uint64_t GetMaxDepth() const
+    {
+        return m_maxDepth;
+    }
+
+    const std::unordered_map<std::type_index, uint64_t> &GetByType() const
+    {
+        return m_byType;
+    }
+
+    const std::unordered_map<uint32_t, uint64_t> &GetByContext() const
+    {
+        return m_byContext;
+    }
+
+    // (时间戳, 队列长度)，时间戳以仿真器的时间步为单位
+    const std::vector<std::pair<uint64_t, uint64_t>> &GetDepthSamples() const
+    {
+        return m_depthSamples;
+    }
+
+  private:
+    static inline ProfilingScheduler *s_current = nullptr;
+
+    Ptr<Scheduler> m_inner;
+    bool m_recording = true;
+    uint64_t m_depth = 0;
+    uint64_t m_maxDepth = 0;
+    uint64_t m_executed = 0;
+    uint64_t m_cancelled = 0;
+    std::unordered_map<std::type_index, uint64_t> m_byType;
+    std::unordered_map<uint32_t, uint64_t> m_byContext;
+    int64_t m_sampleStep = 100000000; // 默认 0.1 秒(纳秒时间步)
+    uint64_t m_nextSampleTs = 0;
+    std::vector<std::pair<uint64_t, uint64_t>> m_depthSamples;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(ProfilingScheduler);
+
+} // namespace ns3
+
+// profile 模式下的性能剖析：场景搭建各阶段的墙钟时间、按来源统计的事件数、
+// 频谱信道每次 StartTx 扇出到的接收机数量、事件队列长度随仿真时间的变化，结束时输出为 JSON。
+// 未启用时所有方法都直接返回
+class ScenarioProfiler
+{
+  public:
+    ScenarioProfiler(bool enabled, double sampleInterval)
+        : m_enabled(enabled)
+    {
+        if (!m_enabled) {
+            return;
+        }
+        ObjectFactory factory;
+        factory.SetTypeId("ns3::ProfilingScheduler");
+        Simulator::SetScheduler(factory);
+        m_scheduler = ProfilingScheduler::GetCurrent();
+        if (m_scheduler) {
+            m_scheduler->SetSampleInterval(Seconds(sampleInterval));
+        }
+    }
+
+    bool IsEnabled() const
+    {
+        return m_enabled;
+    }
+
+    // 结束上一个阶段并开始名为 name 的阶段
+    void Begin(const std::string &name)
+    {
+        if (!m_enabled) {
+            return;
+        }
+        End();
+        m_phase = name;
+        m_phaseStart = std::chrono::steady_clock::now();
+    }
+
+    void End()
+    {
+        if (!m_enabled || m_phase.empty()) {
+            return;
+        }
+        m_phases.push_back(std::make_pair(
+            m_phase, std::chrono::duration<double>(std::chrono::steady_clock::now() - m_phaseStart).count()));
+        m_phase.clear();
+    }
+
+    // 按节点ID区分事件上下文属于哪一类节点
+    void SetNodeCategory(const NodeContainer &nodes, const std::string &category)
+    {
+        if (!m_enabled) {
+            return;
+        }
+        for (uint32_t i = 0; i < nodes.GetN(); ++i) {
+            m_nodeCategory[nodes.Get(i)->GetId()] = category;
+        }
+    }
+
+    // 统计信道上的发送次数和每次发送计算路径损耗的接收机数量
+    void ConnectChannel(Ptr<SpectrumChannel> channel)
+    {
+        if (!m_enabled) {
+            return;
+        }
+        channel->TraceConnectWithoutContext("TxSigParams",
+            MakeCallback(&ScenarioProfiler::NotifyStartTx, this));
+        channel->TraceConnectWithoutContext("PathLoss",
+            MakeCallback(&ScenarioProfiler::NotifyPathLoss, this));
+    }
+
+    // Simulator::Run 返回之后、Simulator::Destroy 之前调用，调度器随 Destroy 释放，这里先复制统计量
+    void Finish()
+    {
+        if (!m_enabled) {
+            return;
+        }
+        End();
+        if (m_scheduler) {
+            m_scheduler->StopRecording();
+            m_executed = m_scheduler->GetExecuted();
+            m_cancelled = m_scheduler->GetCancelled();
+            m_maxDepth = m_scheduler->GetMaxDepth();
+            m_byType = m_scheduler->GetByType();
+            m_byContext = m_scheduler->GetByContext();
+            m_depthSamples = m_scheduler->GetDepthSamples();
+            m_scheduler = nullptr;
+            m_haveEvents = true;
+        }
+    }
+
+    void WriteJson(const std::string &fileName, const std::string &label) const
+    {
+        if (!m_enabled) {
+            return;
+        }
+        std::ofstream out(fileName);
+        if (!out.is_open()) {
+            throw std::runtime_error("Unable to open file " + fileName);
+        }
+        out << std::setprecision(9);
+        out << "{\n  \"scenario\": \"" << label << "\",\n  \"phases\": {";
+        for (size_t k = 0; k < m_phases.size(); ++k) {
+            out << (k ? "," : "") << "\n    \"" << m_phases[k].first << "\": " << m_phases[k].second;
+        }
+        out << "\n  },\n";
+
+        // 事件：按上下文所属的节点类型、按事件来源分类、以及执行次数最多的事件类型
+        out << "  \"events\": {\n";
+        if (m_haveEvents) {
+            std::map<std::string, uint64_t> byContext;
+            for (const auto &entry : m_byContext) {
+                auto it = m_nodeCategory.find(entry.first);
+                byContext[entry.first == Simulator::NO_CONTEXT ? "none"
+                          : it == m_nodeCategory.end()           ? "other"
+                                                                 : it->second] += entry.second;
+            }
+            std::map<std::string, uint64_t> bySource;
+            std::vector<std::pair<uint64_t, std::string>> byType;
+            for (const auto &entry : m_byType) {
+                std::string name = Demangle(entry.first.name());
+                bySource[ClassifyEvent(name)] += entry.second;
+                byType.push_back(std::make_pair(entry.second, name));
+            }
+            std::sort(byType.rbegin(), byType.rend());
+            out << "    \"executed\": " << m_executed << ",\n"
+                << "    \"cancelled\": " << m_cancelled << ",\n";
+            WriteObject(out, "byContext", byContext);
+            WriteObject(out, "bySource", bySource);
+            out << "    \"topTypes\": [";
+            for (size_t k = 0; k < byType.size() && k < 20; ++k) {
+                out << (k ? "," : "") << "\n      {\"count\": " << byType[k].first << ", \"type\": \""
+                    << Escape(byType[k].second) << "\"}";
+            }
+            out << "\n    ]\n";
+        }
+        out << "  },\n";
+
+        out << "  \"spectrum\": {\n"
+            << "    \"startTx\": " << m_startTx << ",\n"
+            << "    \"pathLoss\": " << m_pathLoss << ",\n"
+            << "    \"meanFanOut\": " << (m_startTx ? double(m_pathLoss) / m_startTx : 0) << ",\n";
+        WriteObject(out, "startTxBySource", m_startTxBySource, true);
+        out << "  },\n";
+
+        out << "  \"queueDepth\": {\n";
+        if (m_haveEvents) {
+            out << "    \"max\": " << m_maxDepth << ",\n    \"samples\": [";
+            for (size_t k = 0; k < m_depthSamples.size(); ++k) {
+                out << (k ? ", " : "") << "[" << TimeStep(m_depthSamples[k].first).GetSeconds() << ", "
+                    << m_depthSamples[k].second << "]";
+            }
+            out << "]\n";
+        }
+        out << "  }\n}\n";
+    }
+
+  private:
+    void NotifyStartTx(Ptr<SpectrumSignalParameters> params)
+    {
+        m_startTx++;
+        std::string source = params->txPhy ? Demangle(typeid(*params->txPhy).name()) : "unknown";
+        m_startTxBySource[source.find("WaveformGenerator") != std::string::npos ? "waveform" : "wifi"]++;
+    }
+
+    void NotifyPathLoss(Ptr<const SpectrumPhy> txPhy, Ptr<const SpectrumPhy> rxPhy, double lossDb)
+    {
+        m_pathLoss++;
+    }
+
+    static std::string Demangle(const char *name)
+    {
+        int status = 0;
+        char *demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+        std::string result = status == 0 && demangled ? demangled : name;
+        free(demangled);
+        return result;
+    }
+
+    // 事件对象的类型名包含被调度的成员函数所属的类，据此判断事件来源
+    static std::string ClassifyEvent(const std::string &name)
+    {
+        static const std::vector<std::pair<std::string, std::vector<std::string>>> rules = {
+            {"waveform", {"WaveformGenerator"}},
+            {"application", {"OnOffApplication", "PacketSink", "Application"}},
+            {"channel", {"SpectrumChannel", "SpectrumPhy"}},
+            {"wifiPhy", {"WifiPhy", "PhyEntity", "InterferenceHelper", "WifiPpdu"}},
+            {"wifiMac", {"Mac", "Txop", "ChannelAccessManager", "FrameExchangeManager", "WifiRemoteStation"}},
+            {"internet", {"Ipv4", "Udp", "Arp", "Icmp"}},
+            {"flowMonitor", {"FlowMonitor"}},
+        };
+        for (const auto &rule : rules) {
+            for (const auto &pattern : rule.second) {
+                if (name.find(pattern) != std::string::npos) {
+                    return rule.first;
+                }
+            }
+        }
+        return "other";
+    }
+
+    static std::string Escape(const std::string &text)
+    {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    static void WriteObject(std::ostream &out,
+                            const std::string &name,
+                            const std::map<std::string, uint64_t> &values,
+                            bool last = false)
+    {
+        out << "    \"" << name << "\": {";
+        size_t k = 0;
+        for (const auto &entry : values) {
+            out << (k++ ? ", " : "") << "\"" << entry.first << "\": " << entry.second;
+        }
+        out << (last ? "}\n" : "},\n");
+    }
+
+    bool m_enabled;
+    ProfilingScheduler *m_scheduler = nullptr;
+    std::string m_phase;
+    std::chrono::steady_clock::time_point m_phaseStart;
+    std::vector<std::pair<std::string, double>> m_phases;
+    std::unordered_map<uint32_t, std::string> m_nodeCategory;
+    bool m_haveEvents = false;
+    uint64_t m_executed = 0;
+    uint64_t m_cancelled = 0;
+    uint64_t m_maxDepth = 0;
+    std::unordered_map<std::type_index, uint64_t> m_byType;
+    std::unordered_map<uint32_t, uint64_t> m_byContext;
+    std::vector<std::pair<uint64_t, uint64_t>> m_depthSamples;
+    uint64_t m_startTx = 0;
+    uint64_t m_pathLoss = 0;
+    std::map<std::string, uint64_t> m_startTxBySource;
+};
+
+#endif // SCENARIO_PROFILER_H
@@ -0,0 +1,233 @@
+#ifndef STREAMING_FLOW_STATS_H
+#define STREAMING_FLOW_STATS_H
+
+#include "FlowStatsIndex.h"
+
+#include <queue>
+
+// 流统计时间序列的二进制格式：32 字节的文件头 + 定长记录(小端序)
+struct FlowStreamHeader
+{
+    char magic[8];      // "NS3FST"
+    uint32_t version;
+    uint32_t recordSize; // sizeof(FlowStreamRecord)
+    double binWidth;     // 统计周期(秒)
+    uint32_t nodes;      // 无线节点数量 N
+    uint32_t seed;       // 随机种子
+};
+static_assert(sizeof(FlowStreamHeader) == 32, "FlowStreamHeader must stay 32 bytes");
+
+// 一条流在一个统计周期内的结果，吞吐率单位为 Mbps，psr 为百分数
+struct FlowStreamRecord
+{
+    double time;        // 统计周期的结束时刻(秒)
+    uint16_t source;
+    uint16_t sink;
+    uint32_t txPackets;
+    uint32_t rxPackets;
+    float throughput;
+    float psr;
+    float delay;        // 本周期收到的分组的平均时延(毫秒)
+};
+static_assert(sizeof(FlowStreamRecord) == 32, "FlowStreamRecord must stay 32 bytes");
+
+static const char kFlowStreamMagic[8] = {'N', 'S', '3', 'F', 'S', 'T', 0, 0};
+static const uint32_t kFlowStreamVersion = 1;
+
+// 按固定周期输出每条流的吞吐率、psr 和时延。
+// 每个周期只调度一个事件，按与上一周期累计值的差值计算；每条流只保存上一周期的累计值，
+// 结果先写入固定大小的缓冲区，满了再追加到文件，内存占用与仿真时长无关。
+// 流在开始时间之前不参与统计，连续 retireAfter 秒没有新的分组后不再统计
+class StreamingFlowStats
+{
+  public:
+    // binWidth 为 0 表示不输出；format 为 csv 或 binary
+    StreamingFlowStats(FlowStatsIndex *flowIndex, double binWidth, const std::string &format,
+                       const std::string &outputPrefix, uint32_t nodes, uint32_t seed)
+        : m_flowIndex(flowIndex),
+          m_binWidth(binWidth),
+          m_binary(format == "binary")
+    {
+        if (!Enabled()) {
+            return;
+        }
+        if (format != "csv" && format != "binary") {
+            throw std::runtime_error("Unknown stream format " + format);
+        }
+        m_retireAfter = std::max(1.0, 2 * binWidth);
+        m_fileName = outputPrefix + (m_binary ? "_stream.bin" : "_stream.csv");
+        m_file = fopen(m_fileName.c_str(), "wb");
+        if (m_file == nullptr) {
+            throw std::runtime_error("Unable to open file " + m_fileName);
+        }
+        m_buffer.reserve(kBufferSize);
+        if (m_binary) {
+            FlowStreamHeader header;
+            std::memset(&header, 0, sizeof(header));
+            std::memcpy(header.magic, kFlowStreamMagic, sizeof(header.magic));
+            header.version = kFlowStreamVersion;
+            header.recordSize = sizeof(FlowStreamRecord);
+            header.binWidth = binWidth;
+            header.nodes = nodes;
+            header.seed = seed;
+            Append(reinterpret_cast<const char *>(&header), sizeof(header));
+        } else {
+            const char *header = "time,source,sink,txPackets,rxPackets,throughput,psr,delayMs\n";
+            Append(header, strlen(header));
+        }
+    }
+
+    ~StreamingFlowStats()
+    {
+        if (m_file != nullptr) { // 没有调用 Close 时尽量保存已有的结果
+            WriteBuffer();
+            fclose(m_file);
+        }
+    }
+
+    bool Enabled() const
+    {
+        return m_binWidth > 0;
+    }
+
+    // 统计一条已经在 FlowStatsIndex 中登记的流，startTime 为该流的开始时刻(绝对时间，秒)
+    void Track(uint32_t handle, uint16_t source, uint16_t sink, double startTime)
+    {
+        if (!Enabled()) {
+            return;
+        }
+        Flow flow;
+        flow.handle = handle;
+        flow.source = source;
+        flow.sink = sink;
+        flow.lastChange = startTime;
+        m_pending.push(flow);
+    }
+
+    // 在仿真开始之前调用
+    void Start()
+    {
+        if (Enabled()) {
+            Simulator::Schedule(Seconds(m_binWidth), &StreamingFlowStats::Bin, this);
+        }
+    }
+
+    // 仿真结束后写出缓冲区中剩余的结果
+    void Close()
+    {
+        if (m_file == nullptr) {
+            return;
+        }
+        bool ok = WriteBuffer();
+        fclose(m_file);
+        m_file = nullptr;
+        if (!ok) {
+            throw std::runtime_error("Unable to write file " + m_fileName);
+        }
+        std::cout << "流统计时间序列共 " << m_records << " 条记录，保存在 " << m_fileName << std::endl;
+    }
+
+  private:
+    struct Flow
+    {
+        uint32_t handle = 0;
+        uint16_t source = 0;
+        uint16_t sink = 0;
+        double lastChange = 0; // 最近一次有新分组的时刻，开始之前为开始时刻
+        uint64_t txPackets = 0;
+        uint64_t rxPackets = 0;
+        uint64_t rxBytes = 0;
+        double delaySum = 0;
+    };
+
+    struct LaterStart
+    {
+        bool operator()(const Flow &a, const Flow &b) const
+        {
+            return a.lastChange > b.lastChange;
+        }
+    };
+
+    static const size_t kBufferSize = 1 << 16;
+
+    void Bin()
+    {
+        double now = Simulator::Now().GetSeconds();
+        while (!m_pending.empty() && m_pending.top().lastChange < now) {
+            m_active.push_back(m_pending.top());
+            m_pending.pop();
+        }
+        FlowCounters counters;
+        for (size_t k = 0; k < m_active.size();) {
+            Flow &flow = m_active[k];
+            if (m_flowIndex->GetCounters(flow.handle, &counters) &&
+                (counters.txPackets != flow.txPackets || counters.rxPackets != flow.rxPackets)) {
+                Write(now, flow, counters);
+                flow.lastChange = now;
+            } else if (now - flow.lastChange > m_retireAfter) {
+                m_active[k] = m_active.back(); // 流已经结束
+                m_active.pop_back();
+                continue;
+            }
+            ++k;
+        }
+        Simulator::Schedule(Seconds(m_binWidth), &StreamingFlowStats::Bin, this);
+    }
+
+    // 分组按接收时刻计入所在周期，周期很短时 psr 可能略大于 100
+    void Write(double now, Flow &flow, const FlowCounters &fs)
+    {
+        FlowStreamRecord record;
+        record.time = now;
+        record.source = flow.source;
+        record.sink = flow.sink;
+        record.txPackets = fs.txPackets - flow.txPackets;
+        record.rxPackets = fs.rxPackets - flow.rxPackets;
+        record.throughput = (fs.rxBytes - flow.rxBytes) * 8.0 / m_binWidth / 1024 / 1024;
+        record.psr = record.txPackets > 0 ? record.rxPackets * 100.0 / record.txPackets : 0;
+        record.delay = record.rxPackets > 0 ? (fs.delaySum.GetSeconds() - flow.delaySum) * 1000 / record.rxPackets : 0;
+        flow.txPackets = fs.txPackets;
+        flow.rxPackets = fs.rxPackets;
+        flow.rxBytes = fs.rxBytes;
+        flow.delaySum = fs.delaySum.GetSeconds();
+
+        if (m_binary) {
+            Append(reinterpret_cast<const char *>(&record), sizeof(record));
+        } else {
+            char line[160];
+            int length = snprintf(line, sizeof(line), "%.6f,%u,%u,%u,%u,%.4f,%.3f,%.4f\n", record.time,
+                                  unsigned(record.source), unsigned(record.sink), record.txPackets,
+                                  record.rxPackets, record.throughput, record.psr, record.delay);
+            Append(line, length);
+        }
+        m_records++;
+    }
+
+    void Append(const char *data, size_t size)
+    {
+        if (m_buffer.size() + size > kBufferSize && !WriteBuffer()) {
+            throw std::runtime_error("Unable to write file " + m_fileName);
+        }
+        m_buffer.insert(m_buffer.end(), data, data + size);
+    }
+
+    bool WriteBuffer()
+    {
+        bool ok = m_buffer.empty() || fwrite(m_buffer.data(), 1, m_buffer.size(), m_file) == m_buffer.size();
+        m_buffer.clear();
+        return ok;
+    }
+
+    FlowStatsIndex *m_flowIndex;
+    double m_binWidth;
+    bool m_binary;
+    double m_retireAfter = 1;
+    std::string m_fileName;
+    FILE *m_file = nullptr;
+    std::vector<char> m_buffer;
+    std::priority_queue<Flow, std::vector<Flow>, LaterStart> m_pending; // 按开始时刻排序的未开始的流
+    std::vector<Flow> m_active;
+    uint64_t m_records = 0;
+};
+
+#endif // STREAMING_FLOW_STATS_H
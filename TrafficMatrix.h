@@ -0,0 +1,124 @@
+#ifndef TRAFFIC_MATRIX_H
+#define TRAFFIC_MATRIX_H
+
+#include "FlowStatsIndex.h"
+
+// 全网并发负载测试中的一条流，offered 为提供的负载(Mbps)
+struct TrafficFlow
+{
+    uint16_t source = 0;
+    uint16_t sink = 0;
+    double offered = 0;
+    uint32_t handle = 0; // FlowStatsIndex 中的句柄
+};
+
+// 全网负载测试的汇总结果，吞吐率单位为 Mbps
+struct TrafficSummary
+{
+    uint32_t flows = 0;
+    uint32_t deliveredFlows = 0; // 至少收到一个分组的流
+    double offered = 0;          // 全部流提供的负载之和
+    double goodput = 0;          // 全网在测量时长内收到的有效吞吐率之和
+    double meanPsr = 0;          // 按流平均的psr(百分数)
+    double meanDelay = 0;        // 按收到的分组平均的端到端时延(秒)
+};
+
+// 读取 N×N 的负载矩阵(与吞吐率矩阵格式相同)，第 i 行第 j 列为 i -> j 的负载(Mbps)，0 表示没有流
+std::vector<TrafficFlow> ReadTrafficMatrix(const std::string &fileName, uint16_t N)
+{
+    Matrix<double> load = ReadMatrix<double>(fileName);
+    if (load.Rows() != N || load.Cols() != N) {
+        throw std::runtime_error("Traffic matrix " + fileName + " must be " + std::to_string(N) + "x" +
+                                 std::to_string(N));
+    }
+    std::vector<TrafficFlow> flows;
+    for (uint16_t i = 0; i < N; ++i) {
+        for (uint16_t j = 0; j < N; ++j) {
+            if (load[i][j] < 0) {
+                throw std::runtime_error("Negative load in traffic matrix " + fileName);
+            }
+            if (i != j && load[i][j] > 0) {
+                TrafficFlow flow;
+                flow.source = i;
+                flow.sink = j;
+                flow.offered = load[i][j];
+                flows.push_back(flow);
+            }
+        }
+    }
+    return flows;
+}
+
+// 所有流同时运行，仿真结束后只遍历一次各流的累计统计量：
+// 不需要为每条流调度采样事件，流数量很多时也只有一次 O(流数) 的汇总
+std::vector<FlowSample> CollectTrafficSamples(FlowStatsIndex &flowIndex, const std::vector<TrafficFlow> &flows)
+{
+    std::vector<FlowSample> samples;
+    samples.reserve(flows.size());
+    for (const auto &flow : flows) {
+        samples.push_back(flowIndex.Cumulative(flow.handle));
+    }
+    return samples;
+}
+
+// 保存每条流的结果(_traffic_flows.csv)和吞吐率/psr/时延矩阵，返回全网汇总。
+// 吞吐率按测量时长 duration 计算，而不是按首个分组发送到最后一个分组接收的间隔，
+// 这样各流的吞吐率之和就是全网的有效吞吐率
+TrafficSummary SaveTrafficResults(const std::vector<TrafficFlow> &flows, const std::vector<FlowSample> &samples,
+                                  double duration, uint16_t N, const std::string &prefix, bool binaryMatrices,
+                                  uint32_t seed)
+{
+    Matrix<double> throughput(N, N, 0);
+    Matrix<double> psr(N, N, 0);
+    Matrix<double> delay(N, N, 0);
+    std::ofstream csv(prefix + "_traffic_flows.csv");
+    if (!csv.is_open()) {
+        throw std::runtime_error("Unable to open file " + prefix + "_traffic_flows.csv");
+    }
+    csv << "source,sink,offered,throughput,psr,delayMs,txPackets,rxPackets" << std::endl;
+
+    TrafficSummary summary;
+    summary.flows = flows.size();
+    uint64_t rxBytes = 0;
+    uint64_t rxPackets = 0;
+    double delaySum = 0;
+    double psrSum = 0;
+    for (size_t k = 0; k < flows.size(); ++k) {
+        const TrafficFlow &flow = flows[k];
+        const FlowSample &sample = samples[k];
+        double flowThroughput = sample.rxBytes * 8.0 / duration / 1024 / 1024;
+        double flowPsr = sample.txPackets > 0 ? sample.rxPackets * 100.0 / sample.txPackets : 0;
+        throughput[flow.source][flow.sink] = std::round(flowThroughput * 1000.0) / 1000.0;
+        psr[flow.source][flow.sink] = std::round(flowPsr * 1000.0) / 1000.0;
+        delay[flow.source][flow.sink] = sample.delay * 1000; // 毫秒
+        csv << flow.source << "," << flow.sink << "," << flow.offered << "," << flowThroughput << ","
+            << flowPsr << "," << sample.delay * 1000 << "," << sample.txPackets << "," << sample.rxPackets
+            << std::endl;
+
+        summary.offered += flow.offered;
+        summary.deliveredFlows += sample.rxPackets > 0 ? 1 : 0;
+        psrSum += flowPsr;
+        rxBytes += sample.rxBytes;
+        rxPackets += sample.rxPackets;
+        delaySum += sample.delay * sample.rxPackets;
+    }
+    csv.close();
+    SaveMatrix(throughput, prefix + "_traffic_tht_matrix.txt", binaryMatrices, N, seed);
+    SaveMatrix(psr, prefix + "_traffic_psr_matrix.txt", binaryMatrices, N, seed);
+    SaveMatrix(delay, prefix + "_traffic_delay_matrix.txt", binaryMatrices, N, seed);
+
+    summary.goodput = rxBytes * 8.0 / duration / 1024 / 1024;
+    if (summary.flows > 0) {
+        summary.meanPsr = psrSum / summary.flows;
+    }
+    if (rxPackets > 0) {
+        summary.meanDelay = delaySum / rxPackets;
+    }
+    std::cout << "全网负载测试: " << summary.flows << " 条流, 提供负载 " << summary.offered
+              << " Mbps, 有效吞吐率 " << summary.goodput << " Mbps, 平均psr " << summary.meanPsr
+              << "%, 平均时延 " << summary.meanDelay * 1000 << " ms, " << summary.deliveredFlows
+              << " 条流收到了分组" << std::endl;
+    return summary;
+}
+
+#endif // TRAFFIC_MATRIX_H
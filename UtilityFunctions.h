@@ -47,9 +47,13 @@
 #include "ns3/waveform-generator.h"
 #include "ns3/wifi-module.h"
 
+#include "MatrixStore.h"
+
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -60,47 +64,270 @@
 using namespace ns3;
 namespace fs = std::filesystem;
 
-// 从文件中读取矩阵
+// 按行优先连续存放的矩阵，代替 vector<vector<T>>：整个矩阵只分配一次，访问元素不需要经过行指针。
+// 只能移动，需要副本时显式调用 Clone()；At() 检查下标，m[i][j] 和 m(i, j) 不检查。
+// 存储用 shared_ptr<T[]> 持有只是为了 FromShared：mmap 读取的二进制矩阵通过别名指针直接使用映射的页面，
+// 由该指针保持映射有效。两个 Matrix 之间从不共享存储，Clone() 总是分配新的存储
 template <typename T>
-std::vector<std::vector<T>> ReadMatrixFromFile(const std::string& inputFileName) {
+class Matrix
+{
+  public:
+    Matrix() = default;
+
+    Matrix(size_t rows, size_t cols, const T& value = T())
+        : m_rows(rows),
+          m_cols(cols),
+          m_data(new T[rows * cols])
+    {
+        std::fill_n(m_data.get(), rows * cols, value);
+    }
+
+    Matrix(const Matrix&) = delete;
+    Matrix& operator=(const Matrix&) = delete;
+
+    Matrix(Matrix&& other) noexcept
+        : m_rows(other.m_rows),
+          m_cols(other.m_cols),
+          m_data(std::move(other.m_data))
+    {
+        other.m_rows = 0;
+        other.m_cols = 0;
+    }
+
+    Matrix& operator=(Matrix&& other) noexcept
+    {
+        m_rows = other.m_rows;
+        m_cols = other.m_cols;
+        m_data = std::move(other.m_data);
+        if (this != &other) {
+            other.m_rows = 0;
+            other.m_cols = 0;
+        }
+        return *this;
+    }
+
+    // 拷贝按行优先连续存放的数据
+    static Matrix FromData(const T* data, size_t rows, size_t cols)
+    {
+        Matrix matrix(rows, cols);
+        std::copy(data, data + rows * cols, matrix.m_data.get());
+        return matrix;
+    }
+
+    // 直接使用已有的按行优先连续存放的存储，不拷贝数据
+    static Matrix FromShared(std::shared_ptr<T[]> data, size_t rows, size_t cols)
+    {
+        Matrix matrix;
+        matrix.m_rows = rows;
+        matrix.m_cols = cols;
+        matrix.m_data = std::move(data);
+        return matrix;
+    }
+
+    Matrix Clone() const
+    {
+        return FromData(m_data.get(), m_rows, m_cols);
+    }
+
+    size_t Rows() const
+    {
+        return m_rows;
+    }
+
+    size_t Cols() const
+    {
+        return m_cols;
+    }
+
+    bool Empty() const
+    {
+        return m_rows == 0 || m_cols == 0;
+    }
+
+    T* Data()
+    {
+        return m_data.get();
+    }
+
+    const T* Data() const
+    {
+        return m_data.get();
+    }
+
+    // 第 i 行的首地址，m[i][j] 与 vector<vector<T>> 的写法相同
+    T* operator[](size_t i)
+    {
+        return m_data.get() + i * m_cols;
+    }
+
+    const T* operator[](size_t i) const
+    {
+        return m_data.get() + i * m_cols;
+    }
+
+    T& operator()(size_t i, size_t j)
+    {
+        return m_data[i * m_cols + j];
+    }
+
+    const T& operator()(size_t i, size_t j) const
+    {
+        return m_data[i * m_cols + j];
+    }
+
+    T& At(size_t i, size_t j)
+    {
+        CheckIndex(i, j);
+        return m_data[i * m_cols + j];
+    }
+
+    const T& At(size_t i, size_t j) const
+    {
+        CheckIndex(i, j);
+        return m_data[i * m_cols + j];
+    }
+
+    void Fill(const T& value)
+    {
+        std::fill_n(m_data.get(), m_rows * m_cols, value);
+    }
+
+    bool operator==(const Matrix& other) const
+    {
+        return m_rows == other.m_rows && m_cols == other.m_cols &&
+               std::equal(m_data.get(), m_data.get() + m_rows * m_cols, other.m_data.get());
+    }
+
+    bool operator!=(const Matrix& other) const
+    {
+        return !(*this == other);
+    }
+
+  private:
+    void CheckIndex(size_t i, size_t j) const
+    {
+        if (i >= m_rows || j >= m_cols) {
+            throw std::out_of_range("Matrix index (" + std::to_string(i) + ", " + std::to_string(j) +
+                                    ") out of range " + std::to_string(m_rows) + "x" + std::to_string(m_cols));
+        }
+    }
+
+    size_t m_rows = 0;
+    size_t m_cols = 0;
+    std::shared_ptr<T[]> m_data;
+};
+
+// 从文件中读取矩阵，每行的元素个数必须相同，空行被忽略
+template <typename T>
+Matrix<T> ReadMatrixFromFile(const std::string& inputFileName) {
     std::ifstream inputFile(inputFileName.c_str());
-    std::vector<std::vector<T>> matrix;
+    std::vector<T> values;
+    size_t rows = 0;
+    size_t cols = 0;
     std::string line;
     if (!inputFile.is_open()) {
         throw std::runtime_error("File " + inputFileName + " not found");
     }
     while (getline(inputFile, line)) {
         std::istringstream iss(line);
-        std::vector<T> row;
+        size_t count = 0;
         T value;
         while (iss >> value) { // 使用 >> 操作符读取
-            row.push_back(value);
+            values.push_back(value);
+            count++;
             // 如果你的值是通过逗号分隔的，你需要去掉逗号
             if (iss.peek() == ',') iss.ignore();
         }
-        matrix.push_back(row);
+        if (count == 0) {
+            continue;
+        }
+        if (rows > 0 && count != cols) {
+            throw std::runtime_error("Row " + std::to_string(rows) + " of " + inputFileName + " has " +
+                                     std::to_string(count) + " elements, expected " + std::to_string(cols));
+        }
+        cols = count;
+        rows++;
     }
     inputFile.close();
-    return matrix;
+    return Matrix<T>::FromData(values.data(), rows, cols);
 }
-// 将吞吐率矩阵保存到TXT文件中。函数模板，以支持任何类型的二维vector
+// 将吞吐率矩阵保存到TXT文件中。函数模板，以支持任何元素类型
 template <typename T>
-void SaveMatrixToFile(const std::vector<std::vector<T>>& matrix, const std::string& filename) {
+void SaveMatrixToFile(const Matrix<T>& matrix, const std::string& filename) {
     std::ofstream file(filename); 
     if (!file.is_open()) {
         std::cerr << "无法打开文件：" << filename << std::endl;
         return;
     }
     file << std::fixed << std::setprecision(3); // 设置浮点数打印格式为固定的小数点表示法，并保留三位小数
-    for (const auto& row : matrix) {
-        for (const auto& element : row) {
-            file << std::setw(8) << element; // 设置宽度为8，并默认右对齐
+    for (size_t i = 0; i < matrix.Rows(); ++i) {
+        for (size_t j = 0; j < matrix.Cols(); ++j) {
+            file << std::setw(8) << matrix(i, j); // 设置宽度为8，并默认右对齐
         }
         file << "\n";
     }
     file.close();
 }
 
+// 直接以 mmap 的二进制矩阵作为 Matrix 的存储，不拷贝数据，映射在 Matrix 销毁时解除
+template <typename T>
+Matrix<T> ReadMatrixFromBinaryFile(const std::string& filename) {
+    auto mapped = std::make_shared<MappedMatrix<T>>(filename);
+    size_t rows = mapped->Rows();
+    size_t cols = mapped->Cols();
+    T* data = mapped->MutableData();
+    return Matrix<T>::FromShared(std::shared_ptr<T[]>(std::move(mapped), data), rows, cols);
+}
+
+// 读取矩阵，若存在不比文本文件旧的二进制文件，则直接 mmap 二进制文件
+template <typename T>
+Matrix<T> ReadMatrix(const std::string& textFileName) {
+    std::string binaryFileName = BinaryMatrixFileName(textFileName);
+    std::error_code ec;
+    if (fs::exists(binaryFileName, ec) &&
+        (!fs::exists(textFileName, ec) ||
+         fs::last_write_time(binaryFileName, ec) >= fs::last_write_time(textFileName, ec))) {
+        return ReadMatrixFromBinaryFile<T>(binaryFileName);
+    }
+    return ReadMatrixFromFile<T>(textFileName);
+}
+
+// 保存矩阵到文本文件，binary 为 true 时同时保存一份二进制文件
+template <typename T>
+void SaveMatrix(const Matrix<T>& matrix, const std::string& textFileName,
+                bool binary, uint32_t nodes = 0, uint32_t seed = 0, uint64_t configHash = 0) {
+    SaveMatrixToFile(matrix, textFileName);
+    if (binary) {
+        SaveMatrixToBinaryFile(matrix.Data(), matrix.Rows(), matrix.Cols(), BinaryMatrixFileName(textFileName),
+                               nodes, seed, configHash);
+    }
+}
+
+// 文本矩阵与二进制矩阵之间的相互转换，根据扩展名判断转换方向。
+// 文本文件中路由表为整数矩阵，其余(吞吐率、psr)为浮点矩阵
+void ConvertMatrixFile(const std::string& inputFileName, uint32_t nodes = 0, uint32_t seed = 0) {
+    fs::path path(inputFileName);
+    if (path.extension() == ".bin") {
+        std::string textFileName = fs::path(inputFileName).replace_extension(".txt").string();
+        if (ReadMatrixDType(inputFileName) == MATRIX_INT32) {
+            SaveMatrixToFile(ReadMatrixFromBinaryFile<int>(inputFileName), textFileName);
+        } else {
+            SaveMatrixToFile(ReadMatrixFromBinaryFile<double>(inputFileName), textFileName);
+        }
+        std::cout << inputFileName << " -> " << textFileName << std::endl;
+    } else {
+        std::string binaryFileName = BinaryMatrixFileName(inputFileName);
+        if (path.filename().string().find("RoutingTable") != std::string::npos) {
+            Matrix<int> matrix = ReadMatrixFromFile<int>(inputFileName);
+            SaveMatrixToBinaryFile(matrix.Data(), matrix.Rows(), matrix.Cols(), binaryFileName, nodes, seed);
+        } else {
+            Matrix<double> matrix = ReadMatrixFromFile<double>(inputFileName);
+            SaveMatrixToBinaryFile(matrix.Data(), matrix.Rows(), matrix.Cols(), binaryFileName, nodes, seed);
+        }
+        std::cout << inputFileName << " -> " << binaryFileName << std::endl;
+    }
+}
+
 // 初始化路由矩阵
 void InitRouteMatrix(const std::string& outputFile, size_t nodes) {
     // 确保输出文件的目录存在，如果不存在则创建
@@ -248,4 +475,19 @@ Ptr<SpectrumModel> generator_Spectrum_Model(uint16_t frequency)
     Ptr<SpectrumModel> spectrumModel = Create<SpectrumModel>(bands);
     return spectrumModel;
 }
-#endif // UTILITY_FUNCTIONS_H
\ No newline at end of file
+// 在给定的频谱模型(Wi-Fi PHY 使用的模型)上构造干扰节点的功率谱密度。
+// 与 generator_Spectrum_Model 一样把功率均匀分布在中心频率两侧各 10 MHz 内，
+// 每个子带按与该范围重叠的比例取值，与信道在两个模型之间转换的结果相同
+Ptr<SpectrumValue> CreateInterfererPsd(Ptr<const SpectrumModel> model, uint16_t frequency, double power)
+{
+    Ptr<SpectrumValue> psd = Create<SpectrumValue>(model);
+    double fl = frequency * 1e6 - 10e6;
+    double fh = frequency * 1e6 + 10e6;
+    size_t index = 0;
+    for (auto band = model->Begin(); band != model->End(); ++band, ++index) {
+        double overlap = std::min(band->fh, fh) - std::max(band->fl, fl);
+        (*psd)[index] = overlap > 0 ? power / 20e6 * overlap / (band->fh - band->fl) : 0;
+    }
+    return psd;
+}
+#endif // UTILITY_FUNCTIONS_H
@@ -0,0 +1,1443 @@
+#ifndef WIFI_SCENARIO_H
+#define WIFI_SCENARIO_H
+
+#include "UtilityFunctions.h"
+
+// 在其余头文件之前定义日志组件，它们的 NS_LOG 输出都归入本程序的组件
+NS_LOG_COMPONENT_DEFINE("wifi-spectrum-interference-routing");
+
+#include "AdaptiveMeasurement.h"
+#include "CachedPropagationLossModel.h"
+#include "FlowStatsIndex.h"
+#include "GridSpectrumChannel.h"
+#include "InterferenceController.h"
+#include "LinkEstimator.h"
+#include "LinkScheduler.h"
+#include "MatrixRouting.h"
+#include "PacketTraceRing.h"
+#include "ResultCache.h"
+#include "RouteOptimizer.h"
+#include "ScenarioProfiler.h"
+#include "StreamingFlowStats.h"
+#include "TrafficMatrix.h"
+
+#include <chrono>
+#include <set>
+
+using namespace ns3;
+using namespace std;
+
+// 全局变量
+static vector<string> modes = 
+{
+    "HtMcs0",  "HtMcs1",  "HtMcs2",  "HtMcs3",  "HtMcs4",  "HtMcs5",  "HtMcs6",  "HtMcs7",
+};
+static vector<string> datarates =
+{
+    "6.5Mb/s",  "13Mb/s",   "19.5Mb/s", "26Mb/s",   "39Mb/s",   "52Mb/s",   "58.5Mb/s",   "65Mb/s",
+};
+// 快进模式的初始化时间上限(秒)
+static const double kFastForwardWarmup = 1;
+// 快进模式下干扰节点在测量时隙开始之前打开的提前量(秒)，远大于波形周期 0.7 ms，
+// 时隙开始时各 PHY 看到的干扰与一直打开时相同
+static const double kInterferenceLead = 0.01;
+
+// 一次仿真的运行模式，各模式互相排斥
+enum ScenarioMode
+{
+    SCENARIO_SINGLE_FLOW, // 只测量 sourceNode -> sinkNode(默认)
+    SCENARIO_LINK_TEST,   // 测量全部链路(--linkTest)
+    SCENARIO_INCREMENTAL, // 只重新测量路由修改影响的节点对(--routeEdits)
+    SCENARIO_OPTIMIZE,    // 仿真内路由优化(--optimizeRounds)
+    SCENARIO_TRAFFIC,     // 全网负载测试(--trafficMatrix)
+    SCENARIO_MCS_SURVEY,  // 多MCS链路测量(--mcsSurvey)
+    SCENARIO_ESTIMATE,    // 解析估计，不运行仿真(--estimate)
+};
+
+// 单次仿真的全部可配置参数
+struct ScenarioConfig
+{
+    uint16_t N = 10; // 无线节点的数量
+    uint16_t M = 2; // 干扰节点的数量
+    uint16_t sourceNode = 0;
+    uint16_t sinkNode = 9; // 默认为 N-1
+    uint16_t power = 10;
+    uint32_t seed = 2000; // 设置随机种子
+    uint32_t run = 0; // 重复仿真的编号(RngRun)，大于 0 时按节点和组件固定随机流；0 表示保持按创建顺序分配的随机流
+    uint8_t mcsIndex = 3; // 设置MCS索引值
+    double datarate = 6.5; // Mbps
+
+    bool channelBonding = false;
+    bool linkTest = false;
+    bool updateRoutes = true;
+    bool reset = false;
+    bool autoLinkTest = true; // 没有链路测试结果或结果已过期时先做一次链路测试；关闭时未测量的单元为零
+    bool concurrentLinkTest = false;
+    double csThreshold = -82; // 载波侦听门限 dBm
+    bool binaryMatrices = false;
+    bool cachedLoss = true; // 静态拓扑下预先计算并缓存节点之间的传播损耗
+    string interferenceMode = "waveform"; // 干扰实现方式：waveform 或 psd
+    double rxNoiseFigure = 7; // Wi-Fi 接收机噪声系数 dB，psd 模式下在此基础上叠加干扰
+    string routingMode = "static"; // 路由实现方式：static(静态路由表) 或 matrix(下一跳矩阵)
+    string routeSwapFile = ""; // matrix 模式下在 routeSwapTime 时刻整体替换为该文件中的路由矩阵
+    double routeSwapTime = 0;
+    bool adaptive = false; // 自适应测量时长：置信区间满足容差后提前结束每条链路的测量
+    AdaptiveOptions adaptiveOptions;
+    string cacheDir = ""; // 结果缓存目录，为空表示不使用缓存
+    uint32_t cacheMaxMB = 0; // 缓存大小上限(MB)，0 表示不限制
+    string routeEdits = ""; // 路由表修改列表，只重新测量路径发生变化的源/汇节点对
+    double warmup = 30; // 第一个测量时隙之前的初始化时间(秒)
+    bool fastForward = false; // 快进：缩短初始化时间，干扰节点只在测量时隙内发送
+    uint32_t optimizeRounds = 0; // 仿真内路由优化的轮数，0 表示不优化
+    string optimizeMetric = "widest"; // 路由优化的度量：widest(最宽路径) 或 etx
+    string optimizePairs = "source"; // 路由优化测量的节点对：source(sourceNode->sinkNode) 或 all(全部节点对)
+    double optimizeDamping = 0.5; // 端到端结果低于预测时对链路度量的修正幅度
+    bool profile = false; // 统计各阶段耗时和事件来源，结果保存为 _profile.json
+    double profileInterval = 0.1; // 事件队列长度的采样间隔(仿真秒)
+    string trafficMatrix = ""; // 全网负载矩阵文件(Mbps)，所有非零单元的流同时运行
+    double trafficDuration = 10; // 全网负载测试的时长(秒)
+    double streamBin = 0; // 按该周期(秒)输出每条流的吞吐率、psr和时延的时间序列，0 表示不输出
+    string streamFormat = "csv"; // 时间序列的格式：csv 或 binary
+    bool flowProbe = false; // 用只计数的探针代替 FlowMonitor 统计每条流
+    string spectrumChannel = "multi"; // 频谱信道：multi(MultiModelSpectrumChannel)、single(干扰节点使用 Wi-Fi 的频谱模型) 或 grid(在 single 的基础上按空间网格跳过收不到的接收机)
+    double rxCutoff = -110; // grid 信道中接收功率低于该值(dBm)的传输不投递
+    double gridCellSize = 50; // grid 信道的网格边长(米)
+    double areaSize = 90; // 节点随机分布的正方形区域边长(米)
+    string mcsSurvey = ""; // 在一次仿真中依次用这些MCS(逗号分隔，all 表示 0-7)测量全部链路
+    uint32_t traceRing = 0; // 每个节点保留的最近 PHY/MAC 事件数，0 表示不跟踪
+    double traceSample = 1; // 跟踪事件的记录比例
+    double tracePsrThreshold = 0; // 流的 psr(百分数)低于该值时写出跟踪缓冲区
+    double traceDumpTime = -1; // 在该时刻写出跟踪缓冲区，负数表示不写出
+    uint32_t traceMaxDumps = 10; // 写出跟踪缓冲区的次数上限
+    bool estimate = false; // 不运行仿真，由链路预算和误码率模型解析估计全部链路的 psr 和吞吐率
+    double estimateSinrOffset = 0; // 解析估计的 SINR 修正量(dB)，取自校准报告
+    ScenarioMode mode = SCENARIO_SINGLE_FLOW; // 运行模式，由 CheckScenarioConfig 根据上面各测量方式的参数确定
+
+    string outputDir = "txtfiles/wifi/"; // 输出文件所在目录
+    string tag = ""; // 结果文件名后缀，用于区分同一拓扑下的不同参数
+};
+
+// 单次仿真的结果摘要，完整的矩阵仍然保存在结果文件中
+struct ScenarioResult
+{
+    bool ok = false;
+    uint32_t flows = 0;
+    uint32_t windows = 0; // 使用的测量时隙数量
+    double simulatedSeconds = 0;
+    double wallSeconds = 0; // 包括场景搭建在内的总耗时
+    double setupSeconds = 0; // 从开始到调用 Simulator::Run 之前的场景搭建耗时
+    double runSeconds = 0; // Simulator::Run 的耗时
+    uint64_t events = 0; // Simulator::Run 执行的事件数
+    double throughput = 0; // sourceNode -> sinkNode 的吞吐率
+    double psr = 0;
+    double meanThroughput = 0; // 所有链路的平均吞吐率
+    double meanPsr = 0;
+    uint64_t lossCacheHits = 0; // 传播损耗缓存命中次数
+    uint64_t lossCacheMisses = 0;
+    uint64_t deliveries = 0; // grid 信道投递给接收机的次数
+    uint64_t culledDeliveries = 0; // grid 信道跳过的投递次数
+    bool cacheHit = false; // 结果直接取自结果缓存，没有运行仿真
+    double goodput = 0; // 全网负载测试中所有流的有效吞吐率之和
+};
+
+// 在命令行中注册所有场景参数，命令行解析和参数扫描共用这一份定义
+void AddScenarioOptions(CommandLine &cmd, ScenarioConfig &config)
+{
+    cmd.AddValue("sinkNode", "信号的接收节点", config.sinkNode);
+    cmd.AddValue("sourceNode", "信号的发送节点", config.sourceNode);
+    cmd.AddValue("N", "无线网络中节点的数量", config.N);
+    cmd.AddValue("M", "无线网络中干扰节点的数量", config.M);
+    cmd.AddValue("power", "干扰功率", config.power);
+    cmd.AddValue("seed", "随机种子", config.seed);
+    cmd.AddValue("run", "重复仿真的编号(RngRun)：节点位置仍只由seed决定，大于0时MAC和协议栈使用固定编号的随机流，0表示按创建顺序分配", config.run);
+    cmd.AddValue("mcsIndex","Wi-Fi的MCS索引",config.mcsIndex);
+    cmd.AddValue("datarate","app的发送速率",config.datarate);
+    cmd.AddValue("linkTest", "是否进行网络中的链路状态测试", config.linkTest);
+    cmd.AddValue("updateRoutes", "是否更新路由", config.updateRoutes);
+    cmd.AddValue("reset", "是否重置吞吐率和psr文件", config.reset);
+    cmd.AddValue("autoLinkTest", "没有链路测试结果或结果已过期时先做一次链路测试；关闭时从零矩阵开始，只测量本次的链路(路由优化总是需要链路测试结果)", config.autoLinkTest);
+    cmd.AddValue("concurrentLinkTest", "链路测试时将互不干扰的链路放在同一时隙并行测量", config.concurrentLinkTest);
+    cmd.AddValue("csThreshold", "构建冲突图时使用的载波侦听门限(dBm)", config.csThreshold);
+    cmd.AddValue("binaryMatrices", "同时以二进制格式保存矩阵文件，读取时优先使用二进制文件", config.binaryMatrices);
+    cmd.AddValue("cachedLoss", "预先计算并缓存节点之间的传播损耗", config.cachedLoss);
+    cmd.AddValue("interferenceMode", "干扰实现方式：waveform(波形发生器) 或 psd(折算为接收机噪声)", config.interferenceMode);
+    cmd.AddValue("rxNoiseFigure", "Wi-Fi接收机噪声系数(dB)", config.rxNoiseFigure);
+    cmd.AddValue("routingMode", "路由实现方式：static(Ipv4StaticRouting) 或 matrix(按下一跳矩阵O(1)查表)", config.routingMode);
+    cmd.AddValue("routeSwapFile", "matrix路由模式下，在routeSwapTime时刻整体替换为该文件中的路由矩阵", config.routeSwapFile);
+    cmd.AddValue("routeSwapTime", "替换路由矩阵的仿真时刻(秒)", config.routeSwapTime);
+    cmd.AddValue("adaptive", "自适应测量时长，psr和吞吐率的置信区间满足容差后提前结束测量", config.adaptive);
+    cmd.AddValue("adaptiveInterval", "自适应测量的采样周期(秒)", config.adaptiveOptions.interval);
+    cmd.AddValue("adaptiveMinTime", "自适应测量时每条链路的最短测量时间(秒)", config.adaptiveOptions.minTime);
+    cmd.AddValue("adaptiveMaxTime", "自适应测量时每条链路的最长测量时间(秒)", config.adaptiveOptions.maxTime);
+    cmd.AddValue("psrTolerance", "自适应测量时psr 95%置信区间半宽的上限(百分点)", config.adaptiveOptions.psrTolerance);
+    cmd.AddValue("throughputTolerance", "自适应测量时吞吐率95%置信区间半宽的上限(相对于均值)", config.adaptiveOptions.throughputTolerance);
+    cmd.AddValue("cacheDir", "结果缓存目录，相同配置和路由表的仿真直接复用缓存的结果", config.cacheDir);
+    cmd.AddValue("cacheMaxMB", "结果缓存的大小上限(MB)，超出时淘汰最久未使用的条目，0表示不限制", config.cacheMaxMB);
+    cmd.AddValue("routeEdits", "路由表修改列表文件，每行为 源节点 目的节点 新的下一跳；只重新测量路径改变的节点对并就地更新结果矩阵", config.routeEdits);
+    cmd.AddValue("warmup", "第一个测量时隙之前的初始化时间(秒)", config.warmup);
+    cmd.AddValue("fastForward", "快进：初始化时间缩短为不超过1秒，干扰节点在初始化阶段和时隙间隔中保持静默", config.fastForward);
+    cmd.AddValue("optimizeRounds", "在一次仿真中进行的路由优化轮数，每轮根据链路度量选路、安装并测量端到端结果", config.optimizeRounds);
+    cmd.AddValue("optimizeMetric", "路由优化的度量：widest(最宽路径) 或 etx", config.optimizeMetric);
+    cmd.AddValue("optimizePairs", "路由优化测量的节点对：source(sourceNode到sinkNode) 或 all(全部节点对)", config.optimizePairs);
+    cmd.AddValue("optimizeDamping", "端到端结果低于预测值时，每轮对路径上链路度量的修正幅度(0~1)", config.optimizeDamping);
+    cmd.AddValue("profile", "性能剖析：统计场景搭建各阶段耗时、按来源统计事件数和信道扇出，保存为JSON", config.profile);
+    cmd.AddValue("profileInterval", "性能剖析时事件队列长度的采样间隔(仿真秒)", config.profileInterval);
+    cmd.AddValue("trafficMatrix", "全网负载测试：N×N 的负载矩阵文件(Mbps)，所有非零单元的流在静态路由上同时运行", config.trafficMatrix);
+    cmd.AddValue("trafficDuration", "全网负载测试的时长(秒)", config.trafficDuration);
+    cmd.AddValue("streamBin", "按该周期(秒)输出每条流的吞吐率、psr和时延的时间序列(_stream.csv/.bin)，0表示不输出", config.streamBin);
+    cmd.AddValue("streamFormat", "时间序列的格式：csv 或 binary(32字节定长记录)", config.streamFormat);
+    cmd.AddValue("flowProbe", "用挂接在OnOff Tx和PacketSink Rx上的计数探针代替FlowMonitor::InstallAll(不测量时延)", config.flowProbe);
+    cmd.AddValue("spectrumChannel", "频谱信道：multi(各自的频谱模型，发送时转换) 或 single(干扰节点复用Wi-Fi PHY的频谱模型，使用SingleModelSpectrumChannel)", config.spectrumChannel);
+    cmd.AddValue("rxCutoff", "grid信道中接收功率低于该值(dBm)的传输不投递", config.rxCutoff);
+    cmd.AddValue("gridCellSize", "grid信道的网格边长(米)", config.gridCellSize);
+    cmd.AddValue("areaSize", "节点随机分布的正方形区域边长(米)", config.areaSize);
+    cmd.AddValue("traceRing", "环形缓冲区跟踪：每个Wi-Fi节点只保留最近的这么多条PHY/MAC事件，触发时才写入文件，0表示不跟踪", config.traceRing);
+    cmd.AddValue("traceSample", "环形缓冲区跟踪的记录比例(0,1]", config.traceSample);
+    cmd.AddValue("tracePsrThreshold", "流的psr(百分数)低于该值时写出跟踪缓冲区", config.tracePsrThreshold);
+    cmd.AddValue("traceDumpTime", "在该时刻(秒)写出跟踪缓冲区，负数表示不按时间写出", config.traceDumpTime);
+    cmd.AddValue("traceMaxDumps", "写出跟踪缓冲区的次数上限", config.traceMaxDumps);
+    cmd.AddValue("estimate", "解析估计：不运行仿真，按节点位置、干扰功率和误码率模型估计全部链路的psr和吞吐率；已有链路测试结果时输出校准报告", config.estimate);
+    cmd.AddValue("estimateSinrOffset", "解析估计的SINR修正量(dB)，可取校准报告中的建议值", config.estimateSinrOffset);
+    cmd.AddValue("mcsSurvey", "多MCS链路测量：在同一拓扑和干扰节点上依次用这些MCS(逗号分隔，all表示0-7)测量全部链路，结果保存为 链路×MCS 表", config.mcsSurvey);
+    cmd.AddValue("outputDir", "输出文件所在目录", config.outputDir);
+    cmd.AddValue("tag", "结果文件名后缀", config.tag);
+}
+
+// 以 key=value 列表覆盖场景参数
+ScenarioConfig ApplyScenarioOptions(const ScenarioConfig &base, const vector<string> &options)
+{
+    ScenarioConfig config = base;
+    CommandLine cmd;
+    AddScenarioOptions(cmd, config);
+    vector<string> args = {"wifi-interference"};
+    for (const auto &option : options) {
+        args.push_back("--" + option);
+    }
+    cmd.Parse(args);
+    return config;
+}
+
+// 拓扑相关文件(路由表)的前缀，只由 N 和 seed 决定
+string ScenarioFilePrefix(const ScenarioConfig &config)
+{
+    return config.outputDir + "wifi_" + to_string(config.N) + "_" + to_string(config.seed);
+}
+
+// 结果文件(吞吐率、psr矩阵等)的前缀
+string ScenarioResultPrefix(const ScenarioConfig &config)
+{
+    return ScenarioFilePrefix(config) + (config.tag.empty() ? "" : "_" + config.tag);
+}
+
+// 决定链路物理特性的参数，用于判断已有的链路测试结果是否仍然有效
+string ScenarioPhysicsKey(const ScenarioConfig &config)
+{
+    ostringstream key;
+    key << setprecision(17) << "N=" << config.N << " M=" << config.M << " power=" << config.power
+        << " seed=" << config.seed << " mcsIndex=" << unsigned(config.mcsIndex)
+        << " datarate=" << config.datarate << " channelBonding=" << config.channelBonding
+        << " interferenceMode=" << config.interferenceMode << " rxNoiseFigure=" << config.rxNoiseFigure
+        << " adaptive=" << config.adaptive;
+    // 默认值不写入，之前的链路测试结果仍然有效
+    if (config.run > 0) {
+        key << " run=" << config.run;
+    }
+    // 快进模式的初始化时间和干扰时序都不同，在 --validateFastForward 证明结果一致之前单独缓存
+    if (config.fastForward) {
+        key << " fastForward=1";
+    }
+    if (config.spectrumChannel != "multi") {
+        key << " spectrumChannel=" << config.spectrumChannel;
+    }
+    if (config.spectrumChannel == "grid") {
+        key << " rxCutoff=" << config.rxCutoff;
+    }
+    if (config.areaSize != 90) {
+        key << " areaSize=" << config.areaSize;
+    }
+    if (config.adaptive) {
+        const AdaptiveOptions &options = config.adaptiveOptions;
+        key << " adaptiveInterval=" << options.interval << " adaptiveMinTime=" << options.minTime
+            << " adaptiveMaxTime=" << options.maxTime << " psrTolerance=" << options.psrTolerance
+            << " throughputTolerance=" << options.throughputTolerance;
+    }
+    return key.str();
+}
+
+// 结果缓存的键：影响测量结果的全部参数加上路由矩阵的内容。
+// 输出目录、文件后缀、二进制矩阵和传播损耗缓存等不改变结果的选项不参与计算
+uint64_t ScenarioCacheKey(const ScenarioConfig &config, bool linkTest, const Matrix<int> &routingTable,
+                          const vector<Link> &measuredLinks)
+{
+    ostringstream key;
+    key << setprecision(17) << "v2 " << ScenarioPhysicsKey(config) << " linkTest=" << linkTest
+        << " warmup=" << config.warmup;
+    if (linkTest) {
+        key << " concurrentLinkTest=" << config.concurrentLinkTest;
+        if (config.concurrentLinkTest) {
+            key << " csThreshold=" << config.csThreshold;
+        }
+    } else {
+        key << " links=";
+        for (const auto &link : measuredLinks) {
+            key << link.first << "-" << link.second << ",";
+        }
+    }
+    key << " routingMode=" << config.routingMode << " updateRoutes=" << config.updateRoutes;
+    uint64_t hash = Fnv1a64(key.str());
+    auto hashTable = [&](const Matrix<int> &table) {
+        for (size_t i = 0; i < table.Rows(); ++i) {
+            for (size_t j = 0; j < table.Cols(); ++j) {
+                hash = Fnv1a64(to_string(table(i, j)) + " ", hash);
+            }
+            hash = Fnv1a64("\n", hash);
+        }
+    };
+    if (config.updateRoutes) {
+        hashTable(routingTable);
+    }
+    if (config.routingMode == "matrix" && !config.routeSwapFile.empty()) {
+        ostringstream swap;
+        swap << setprecision(17) << " routeSwapTime=" << config.routeSwapTime << "\n";
+        hash = Fnv1a64(swap.str(), hash);
+        hashTable(ReadMatrix<int>(config.routeSwapFile));
+    }
+    return hash;
+}
+
+// 读取路由表修改列表，每行为 "源节点 目的节点 新的下一跳"，# 开头的行为注释
+vector<pair<Link, int>> ReadRouteEdits(const string &fileName)
+{
+    ifstream input(fileName);
+    if (!input.is_open()) {
+        throw runtime_error("File " + fileName + " not found");
+    }
+    vector<pair<Link, int>> edits;
+    string line;
+    while (getline(input, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        istringstream iss(line);
+        int source, destination, nextHop;
+        if (!(iss >> source >> destination >> nextHop)) {
+            throw runtime_error("Invalid route edit \"" + line + "\" in " + fileName);
+        }
+        edits.push_back(make_pair(Link(source, destination), nextHop));
+    }
+    return edits;
+}
+
+// 解析多MCS链路测量的MCS列表，取值超出 0-7 时抛出异常
+vector<uint8_t> ParseMcsList(const string &text)
+{
+    vector<uint8_t> list;
+    if (text == "all") {
+        for (uint8_t mcs = 0; mcs < modes.size(); ++mcs) {
+            list.push_back(mcs);
+        }
+        return list;
+    }
+    istringstream iss(text);
+    string item;
+    while (getline(iss, item, ',')) {
+        if (item.empty()) {
+            continue;
+        }
+        int mcs = stoi(item);
+        if (mcs < 0 || mcs >= int(modes.size())) {
+            throw runtime_error("Invalid MCS " + item + " in mcsSurvey");
+        }
+        list.push_back(mcs);
+    }
+    return list;
+}
+
+// MCS 对应的物理层速率(Mbps)，多MCS链路测量以该速率发送，使链路在每个MCS下都达到饱和
+double McsDataRate(uint8_t mcs)
+{
+    return stod(datarates[mcs]);
+}
+
+// 在仿真运行中切换所有 Wi-Fi 设备的MCS，ConstantRateWifiManager 每次发送时读取这两个属性
+void SetWifiMcs(uint8_t mcs)
+{
+    const string manager = "/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/RemoteStationManager/"
+                           "$ns3::ConstantRateWifiManager/";
+    Config::Set(manager + "DataMode", StringValue(modes[mcs]));
+    Config::Set(manager + "ControlMode", StringValue(modes[mcs]));
+}
+
+// 保存多MCS链路测量的结果：每个MCS一组吞吐率和psr矩阵，以及按 (链路, MCS) 排列的汇总表
+void SaveMcsSurvey(const vector<uint8_t> &mcsList, const vector<Matrix<double>> &throughput,
+                   const vector<Matrix<double>> &psr, const string &prefix, bool binaryMatrices,
+                   uint16_t N, uint32_t seed)
+{
+    string tableFileName = prefix + "_mcs_survey.csv";
+    ofstream table(tableFileName);
+    if (!table.is_open()) {
+        throw runtime_error("Unable to open file " + tableFileName);
+    }
+    table << "source,sink,mcs,mode,offered,throughput,psr" << endl;
+    for (uint16_t i = 0; i < N; ++i) {
+        for (uint16_t j = 0; j < N; ++j) {
+            if (i == j) {
+                continue;
+            }
+            for (size_t m = 0; m < mcsList.size(); ++m) {
+                table << i << "," << j << "," << unsigned(mcsList[m]) << "," << modes[mcsList[m]] << ","
+                      << McsDataRate(mcsList[m]) << "," << throughput[m][i][j] << "," << psr[m][i][j] << endl;
+            }
+        }
+    }
+    for (size_t m = 0; m < mcsList.size(); ++m) {
+        string mcsPrefix = prefix + "_mcs" + to_string(mcsList[m]);
+        SaveMatrix(throughput[m], mcsPrefix + "_tht_matrix.txt", binaryMatrices, N, seed);
+        SaveMatrix(psr[m], mcsPrefix + "_psr_matrix.txt", binaryMatrices, N, seed);
+    }
+    cout << "多MCS链路测量结果保存在 " << tableFileName << endl;
+}
+
+// 由各测量方式的参数确定运行模式(config.mode)，并一次检查全部参数，参数有效时返回空字符串。
+// 测量方式最多只能指定一种，只有路由优化可以同时指定 --linkTest(先做一次链路测试)
+string CheckScenarioConfig(ScenarioConfig &config)
+{
+    vector<pair<bool, ScenarioMode>> requested = {
+        {config.linkTest && config.optimizeRounds == 0, SCENARIO_LINK_TEST},
+        {!config.routeEdits.empty(), SCENARIO_INCREMENTAL},
+        {config.optimizeRounds > 0, SCENARIO_OPTIMIZE},
+        {!config.trafficMatrix.empty(), SCENARIO_TRAFFIC},
+        {!ParseMcsList(config.mcsSurvey).empty(), SCENARIO_MCS_SURVEY},
+        {config.estimate, SCENARIO_ESTIMATE},
+    };
+    config.mode = SCENARIO_SINGLE_FLOW;
+    uint32_t selected = 0;
+    for (const auto &mode : requested) {
+        if (mode.first) {
+            config.mode = mode.second;
+            selected++;
+        }
+    }
+    if (selected > 1) {
+        return "链路测试、增量评估、路由优化、全网负载测试、多MCS链路测量和解析估计只能选择一种"
+               "(路由优化可以与 --linkTest 一起使用)";
+    }
+    if (config.adaptive && config.mode != SCENARIO_SINGLE_FLOW && config.mode != SCENARIO_LINK_TEST &&
+        config.mode != SCENARIO_INCREMENTAL) {
+        return "自适应测量只能用于单条流、链路测试或增量评估";
+    }
+    if (config.mcsIndex > 7) { // 可以通过增加Wi-Fi天线数量的方式，使用更大的MCS索引
+        return "MCS索引值的范围为0-7";
+    }
+    if (config.routingMode != "static" && config.routingMode != "matrix") {
+        return "路由实现方式只能为 static 或 matrix";
+    }
+    if (config.mode == SCENARIO_OPTIMIZE && config.optimizePairs != "source" && config.optimizePairs != "all") {
+        return "路由优化的节点对只能为 source 或 all";
+    }
+    if (config.mode == SCENARIO_TRAFFIC && config.trafficDuration <= 0) {
+        return "全网负载测试的时长必须大于零";
+    }
+    if (config.spectrumChannel != "multi" && config.spectrumChannel != "single" && config.spectrumChannel != "grid") {
+        return "频谱信道只能为 multi、single 或 grid";
+    }
+    // 40 MHz 信道上 20 MHz 的非HT控制帧(ACK等)使用另一个频谱模型，只有 multi 信道能够转换
+    if (config.spectrumChannel != "multi" && config.channelBonding) {
+        return "single 和 grid 频谱信道不能与信道绑定同时使用";
+    }
+    if (config.gridCellSize <= 0 || config.areaSize <= 0) {
+        return "网格边长和区域边长必须大于零";
+    }
+    if (config.streamBin < 0 || (config.streamFormat != "csv" && config.streamFormat != "binary")) {
+        return "时间序列的周期不能小于零，格式只能为 csv 或 binary";
+    }
+    if (config.traceRing > 0 && (config.traceSample <= 0 || config.traceSample > 1)) {
+        return "跟踪的记录比例必须在 (0, 1] 内";
+    }
+    if (config.warmup <= 0.002) { // 干扰节点在 0.002 秒启动
+        return "初始化时间必须大于0.002秒";
+    }
+    if (config.fastForward && config.warmup <= kInterferenceLead) {
+        return "快进模式的初始化时间必须大于" + to_string(kInterferenceLead) + "秒";
+    }
+    const AdaptiveOptions &options = config.adaptiveOptions;
+    if (config.adaptive && (options.interval <= 0 || options.minTime > options.maxTime)) {
+        return "自适应测量的采样周期必须大于零，且最短测量时间不能大于最长测量时间";
+    }
+    return "";
+}
+
+// 计算吞吐率和psr，只读取本条流自上次采样以来的统计量；psr 过低时触发跟踪缓冲区的写出
+void CalculateThroughput(FlowStatsIndex* flowIndex, uint32_t handle,
+    Matrix<double>* throughput, Matrix<double>* psr,
+    uint16_t sourceNode, uint16_t sinkNode, PacketTraceRing* trace)
+{
+    FlowSample sample = flowIndex->Sample(handle);
+    if (sample.flowId == 0) {
+        cout << "No flow from node " << sourceNode << " to node " << sinkNode << endl;
+        trace->CheckFlow(sourceNode, sinkNode, 0);
+        return;
+    }
+    cout << "Flow " << sample.flowId << " (" << sourceNode << " -> " << sinkNode << ")" << endl;
+    cout << "  Packet success rate from " << sourceNode << " to " << sinkNode << " is "
+            << sample.psr / 100 << endl;
+    cout << "  Throughput to " << sinkNode << " :" << sample.throughput << " Mbps" << endl;
+    double psr_value = 0.0;
+    double throughput_value = 0.0;
+
+    // 确保时间间隔大于零
+    if (sample.valid) {
+        // 四舍五入到三位小数
+        throughput_value = std::round(sample.throughput * 1000.0) / 1000.0;
+        psr_value = std::round(sample.psr * 1000.0) / 1000.0; // 百分数表示，保留三位小数
+    } else {
+        // 处理时间间隔不大于零的情况，例如设置吞吐率为零
+        throughput_value = 0.0;
+        psr_value = 0.0;
+    }
+
+    (*throughput)[sourceNode][sinkNode] = throughput_value;
+    (*psr)[sourceNode][sinkNode] = psr_value;
+    trace->CheckFlow(sourceNode, sinkNode, psr_value);
+}
+
+void 
+InitializeDirectRoutes(NodeContainer &nodes, Ipv4StaticRoutingHelper &ipv4RoutingHelper, 
+Ipv4InterfaceContainer &interfaces) 
+{
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable>();
+  for (uint32_t i = 0; i < nodes.GetN(); ++i) {
+    Ptr<Ipv4> ipv4 = nodes.Get(i)->GetObject<Ipv4>();
+    Ptr<Ipv4StaticRouting> staticRouting = ipv4RoutingHelper.GetStaticRouting(ipv4);
+    // 获取路由表中的路由数量
+    int32_t numRoutes = staticRouting->GetNRoutes();
+    // 从后向前遍历路由表，删除除了前两条默认路由之外的所有路由
+    for (int32_t j = numRoutes - 1; j >= 2; --j) {
+      staticRouting->RemoveRoute(j);
+    }
+    // 初始化直接路由
+    for (uint32_t j = 0; j < nodes.GetN(); ++j) {
+      if (i != j) { // 确保不是指向自己的路由
+        Ipv4Address destAddress = interfaces.GetAddress(j, 0);
+        Ipv4Address nextHop = interfaces.GetAddress(j, 0); // 下一跳地址设置为目的地址
+        uint32_t interface = random->GetInteger(1, ipv4->GetNInterfaces() - 1);
+        staticRouting->AddHostRouteTo(destAddress, nextHop, interface);
+      }
+    }
+  }
+}
+void 
+UpdateStaticRoutingTable(NodeContainer &nodes, Ipv4StaticRoutingHelper &ipv4RoutingHelper, 
+Ipv4InterfaceContainer &interfaces, const Matrix<int> &routingTable) 
+{
+    for (uint32_t i = 0; i < nodes.GetN(); ++i) {
+        Ptr<Ipv4> ipv4 = nodes.Get(i)->GetObject<Ipv4>();
+        Ptr<Ipv4StaticRouting> staticRouting = ipv4RoutingHelper.GetStaticRouting(ipv4);
+
+        for (uint32_t j = 0; j < nodes.GetN(); ++j) {
+        if (i != j) { // 确保不是指向自己的路由
+            Ipv4Address destAddress = interfaces.GetAddress(j, 0);
+            int nextHopIndex = routingTable[i][j];
+            Ipv4Address nextHop = interfaces.GetAddress(nextHopIndex, 0);
+            int32_t interface = 2;
+            // 检查是否已存在路由
+            bool routeExists = false;
+            int32_t routeIndex = staticRouting->GetNRoutes();
+            while (routeIndex--) {
+            Ipv4RoutingTableEntry routeEntry = staticRouting->GetRoute(routeIndex);
+            if (routeEntry.GetDest() == destAddress) {
+                interface = routeEntry.GetInterface(); //采用原来的接口
+                routeExists = true;
+                // 如果新路由的metric更低，或者相同但我们想要更新路由，则删除旧路由
+                if (routeEntry.GetGateway() != nextHop || staticRouting->GetMetric(routeIndex) >= 1) {
+                staticRouting->RemoveRoute(routeIndex);
+                routeExists = false; // 允许添加新路由
+                }
+                break;
+            }
+            }
+            // 如果不存在相同目的地的路由，或者旧路由已被删除，则添加新路由
+            if (!routeExists) {
+            staticRouting->AddHostRouteTo(destAddress, nextHop, interface, 0);
+            }
+        }
+        }
+    }
+}
+
+// 解析估计：由节点位置和 PHY 参数估计全部链路的吞吐率和 psr 并保存为矩阵。
+// calibrate 为真时(已有与当前物理参数一致的链路测试结果)逐链路比较并输出校准报告
+void EstimateLinks(const ScenarioConfig &config, Ptr<WifiPhy> phy, const NodeContainer &nodes,
+                   const NodeContainer &interferingNodes, Ptr<PropagationLossModel> lossModel, double waveformPower,
+                   uint32_t packetSize, bool calibrate, Matrix<double> *throughput, Matrix<double> *psr)
+{
+    string prefix = ScenarioResultPrefix(config);
+    LinkEstimatorParams estimatorParams;
+    estimatorParams.mode = WifiMode(modes[config.mcsIndex]);
+    estimatorParams.channelWidth = phy->GetChannelWidth();
+    estimatorParams.band = phy->GetPhyBand();
+    estimatorParams.txPowerDbm = phy->GetTxPowerStart();
+    estimatorParams.noiseFigureDb = config.rxNoiseFigure;
+    estimatorParams.ccaEdThresholdDbm = phy->GetCcaEdThreshold();
+    estimatorParams.interfererPower = waveformPower;
+    estimatorParams.packetSize = packetSize;
+    estimatorParams.offeredRate = config.datarate;
+    estimatorParams.slot = phy->GetSlot();
+    estimatorParams.sifs = phy->GetSifs();
+    LinkBudget budget = ComputeLinkBudget(estimatorParams, nodes, interferingNodes, lossModel);
+    LinkEstimator estimator(estimatorParams);
+    estimator.Estimate(budget, config.estimateSinrOffset, throughput, psr);
+    SaveMatrix(*throughput, prefix + "_tht_est_matrix.txt", config.binaryMatrices, config.N, config.seed);
+    SaveMatrix(*psr, prefix + "_psr_est_matrix.txt", config.binaryMatrices, config.N, config.seed);
+    SaveMatrix(budget.sinrDb, prefix + "_sinr_est_matrix.txt", config.binaryMatrices, config.N, config.seed);
+
+    if (calibrate) {
+        EstimatorCalibration calibration = CalibrateLinkEstimator(estimator, budget, config.estimateSinrOffset,
+            ReadMatrix<double>(prefix + "_tht_init_matrix.txt"), ReadMatrix<double>(prefix + "_psr_init_matrix.txt"),
+            prefix);
+        string reportFileName = prefix + "_estimate_report.txt";
+        ofstream report(reportFileName);
+        report << "links=" << calibration.links << "\n"
+               << "sinrOffsetDb=" << config.estimateSinrOffset << "\n"
+               << "psrMae=" << calibration.psrMae << "\n"
+               << "throughputMae=" << calibration.throughputMae << "\n"
+               << "psrRankCorrelation=" << calibration.psrRank << "\n"
+               << "throughputRankCorrelation=" << calibration.throughputRank << "\n"
+               << "usableAgreement=" << calibration.usableAgreement << "\n"
+               << "suggestedSinrOffsetDb=" << config.estimateSinrOffset + calibration.bestOffsetDb << "\n"
+               << "suggestedPsrMae=" << calibration.bestOffsetPsrMae << endl;
+        cout << "解析估计与链路测试比较(" << calibration.links << " 条链路): psr 平均绝对误差 "
+             << calibration.psrMae << " 个百分点, 吞吐率平均绝对误差 " << calibration.throughputMae
+             << " Mbps, 吞吐率秩相关 " << calibration.throughputRank << ", 可用链路判断一致 "
+             << calibration.usableAgreement * 100 << "%; 建议 --estimateSinrOffset="
+             << config.estimateSinrOffset + calibration.bestOffsetDb << " (psr 误差 "
+             << calibration.bestOffsetPsrMae << "), 报告保存在 " << reportFileName << endl;
+    } else {
+        cout << "没有与当前物理参数一致的链路测试结果，不输出校准报告" << endl;
+    }
+}
+
+// 各运行模式安装接收应用和数据流时共用的场景对象和测量状态，引用的都是 RunScenario 中的局部变量
+struct FlowSetupContext
+{
+    uint16_t N;
+    NodeContainer nodes;
+    PacketSinkHelper sink;
+    ApplicationContainer &sinkApps;
+    const double &startTime; // 下一个测量时隙的开始时刻，measureWindow 占用时隙后后移
+    Matrix<double> *&windowThroughput; // 数据流的测量结果写入的矩阵
+    Matrix<double> *&windowPsr;
+    double &flowRate; // 数据流的发送速率(Mbps)
+    std::function<void(const vector<Link> &)> measureWindow; // 在同一个测量时隙中测量这些链路
+    Ptr<PropagationLossModel> lossModel; // 并行链路测试构建冲突图时使用
+    double txPowerDbm;
+    double csThreshold;
+};
+
+// 在每个节点上安装接收应用
+void InstallAllSinks(FlowSetupContext &ctx)
+{
+    for (uint16_t i = 0; i < ctx.N; i++) {
+        ctx.sinkApps.Add(ctx.sink.Install(ctx.nodes.Get(i)));
+    }
+}
+
+// 全部链路的测量时隙，链路按汇节点、源节点的顺序排列。
+// 并行测量时按冲突图把互不干扰的链路放在同一时隙，否则每个时隙一条链路
+vector<vector<Link>> BuildLinkTestSlots(FlowSetupContext &ctx, bool concurrent)
+{
+    vector<Link> links;
+    for (uint16_t j = 0; j < ctx.N; j++) {
+        for (uint16_t i = 0; i < ctx.N; i++) {
+            if (i != j) {
+                links.push_back(Link(i, j));
+            }
+        }
+    }
+    vector<vector<Link>> slots;
+    if (concurrent) {
+        Matrix<bool> hears = ComputeCarrierSenseMatrix(ctx.nodes, ctx.lossModel, ctx.txPowerDbm, ctx.csThreshold);
+        slots = BuildConcurrentLinkSchedule(links, hears);
+        NS_LOG_INFO("并行链路测试使用 " << slots.size() << " 个时隙, 顺序测试需要 " << links.size() << " 个时隙");
+    } else {
+        for (const auto &link : links) {
+            slots.push_back({link});
+        }
+    }
+    return slots;
+}
+
+// 链路测试：测量全部链路
+void SetupLinkTestFlows(FlowSetupContext &ctx, bool concurrent)
+{
+    InstallAllSinks(ctx);
+    for (const auto &slot : BuildLinkTestSlots(ctx, concurrent)) {
+        ctx.measureWindow(slot);
+    }
+}
+
+// 增量评估：只测量路径改变的节点对，其余单元沿用结果矩阵中的值
+void SetupIncrementalFlows(FlowSetupContext &ctx, const vector<Link> &changedLinks)
+{
+    set<uint16_t> sinks;
+    for (const auto &link : changedLinks) {
+        if (sinks.insert(link.second).second) {
+            ctx.sinkApps.Add(ctx.sink.Install(ctx.nodes.Get(link.second)));
+        }
+        ctx.measureWindow({link});
+    }
+}
+
+// 多MCS链路测量：拓扑、移动模型和干扰节点只建立一次，依次在每个MCS下测量全部链路，
+// 冲突图只与位置和发射功率有关，所有MCS共用同一个时隙划分
+void SetupMcsSurveyFlows(FlowSetupContext &ctx, bool concurrent, const vector<uint8_t> &surveyMcs, double gap,
+                         vector<Matrix<double>> *surveyThroughput, vector<Matrix<double>> *surveyPsr)
+{
+    InstallAllSinks(ctx);
+    vector<vector<Link>> slots = BuildLinkTestSlots(ctx, concurrent);
+    for (size_t m = 0; m < surveyMcs.size(); m++) { // 先建好全部矩阵，下面保存的指针不会失效
+        surveyThroughput->emplace_back(ctx.N, ctx.N, 0);
+        surveyPsr->emplace_back(ctx.N, ctx.N, 0);
+    }
+    for (size_t m = 0; m < surveyMcs.size(); m++) {
+        if (m == 0) {
+            SetWifiMcs(surveyMcs[m]);
+        } else { // 在上一个MCS最后一个时隙之后的间隔中切换
+            Simulator::Schedule(Seconds(ctx.startTime - gap / 2), &SetWifiMcs, surveyMcs[m]);
+        }
+        ctx.windowThroughput = &(*surveyThroughput)[m];
+        ctx.windowPsr = &(*surveyPsr)[m];
+        ctx.flowRate = McsDataRate(surveyMcs[m]); // 固定的 --datarate 低于高阶MCS的容量，各MCS的吞吐率会完全相同
+        for (const auto &slot : slots) {
+            ctx.measureWindow(slot);
+        }
+    }
+}
+
+// 全网负载测试：所有流同时开始、同时结束，不调度任何按流的采样事件；返回流的数量
+uint32_t SetupTrafficFlows(FlowSetupContext &ctx, const Ipv4InterfaceContainer &ip, uint16_t port,
+                           uint32_t packetSize, double duration, vector<TrafficFlow> *flows, FlowStatsIndex *flowIndex,
+                           StreamingFlowStats *streamStats, ApplicationContainer *sourceApps)
+{
+    vector<bool> hasSink(ctx.N, false);
+    for (auto &flow : *flows) {
+        if (!hasSink[flow.sink]) {
+            hasSink[flow.sink] = true;
+            ctx.sinkApps.Add(ctx.sink.Install(ctx.nodes.Get(flow.sink)));
+        }
+        OnOffHelper onoff("ns3::UdpSocketFactory", InetSocketAddress(ip.GetAddress(flow.sink), port));
+        onoff.SetConstantRate(DataRate(to_string(flow.offered)+"Mb/s"), packetSize);
+        onoff.SetAttribute("StartTime", TimeValue(Seconds(ctx.startTime)));
+        onoff.SetAttribute("StopTime", TimeValue(Seconds(ctx.startTime + duration)));
+        ApplicationContainer app = onoff.Install(ctx.nodes.Get(flow.source));
+        sourceApps->Add(app);
+        flow.handle = flowIndex->Register(ip.GetAddress(flow.source), ip.GetAddress(flow.sink), port, app.Get(0));
+        streamStats->Track(flow.handle, flow.source, flow.sink, ctx.startTime);
+    }
+    return flows->size();
+}
+
+// 单条流：只测量 sourceNode -> sinkNode
+void SetupSingleFlow(FlowSetupContext &ctx, uint16_t sourceNode, uint16_t sinkNode)
+{
+    ctx.sinkApps.Add(ctx.sink.Install(ctx.nodes.Get(sinkNode)));
+    if (sourceNode != sinkNode) {
+        ctx.measureWindow({Link(sourceNode, sinkNode)});
+    } else {
+        cerr << "sourceNode和sinkNode不能相同" << endl;
+    }
+}
+
+// 搭建并运行一次完整的仿真
+ScenarioResult RunScenario(const ScenarioConfig &scenario)
+{
+    ScenarioConfig config = scenario;
+    string error = CheckScenarioConfig(config);
+    if (!error.empty()) {
+        cerr << error << endl;
+        return ScenarioResult();
+    }
+
+    // 常量和配置
+    const double simulationTime = 1; // seconds
+    const double T = 1; // 间隔时间
+    const uint32_t packetSize = 1420;
+    const double minX = 10;
+    const double maxX = minX + config.areaSize;
+    const double minY = 10;
+    const double maxY = minY + config.areaSize;
+    const double frequencyMode = 2.4; 
+
+    // 动态配置变量
+    uint16_t N = config.N; // 无线节点的数量
+    uint16_t M = config.M; // 干扰节点的数量
+    uint16_t sourceNode = config.sourceNode;
+    uint16_t sinkNode = config.sinkNode;
+    uint16_t power = config.power;
+    uint32_t seed = config.seed; // 设置随机种子
+    uint8_t mcsIndex = config.mcsIndex; // 设置MCS索引值
+    double datarate = config.datarate; // Mbps
+    const double waveformPower = power * 1e-4;
+
+    // 状态标志
+    bool channelBonding = config.channelBonding;
+    bool linkTest = config.linkTest; // 链路测试模式，或路由优化之前先做一次链路测试
+    bool updateRoutes = config.updateRoutes;
+    bool reset = config.reset;
+    bool concurrentLinkTest = config.concurrentLinkTest;
+    double csThreshold = config.csThreshold; // 载波侦听门限 dBm
+    bool binaryMatrices = config.binaryMatrices;
+    bool cachedLoss = config.cachedLoss;
+    InterferenceMode interferenceMode = ParseInterferenceMode(config.interferenceMode);
+    bool matrixRouting = config.routingMode == "matrix";
+
+    ScenarioResult result;
+    auto wallStart = chrono::steady_clock::now();
+    const AdaptiveOptions &adaptiveOptions = config.adaptiveOptions;
+    RouteMetric routeMetric = ParseRouteMetric(config.optimizeMetric);
+    bool optimizing = config.mode == SCENARIO_OPTIMIZE;
+    bool incremental = config.mode == SCENARIO_INCREMENTAL;
+    bool traffic = config.mode == SCENARIO_TRAFFIC;
+    bool mcsSurvey = config.mode == SCENARIO_MCS_SURVEY;
+    vector<uint8_t> surveyMcs = ParseMcsList(config.mcsSurvey);
+
+    // 需要在调度任何事件之前安装统计用的调度器
+    ScenarioProfiler profiler(config.profile, config.profileInterval);
+    profiler.Begin("readMatrices");
+
+    // 文件名和数据结构
+    string file_prefix = ScenarioFilePrefix(config);
+    string result_prefix = ScenarioResultPrefix(config);
+    string throughputFileName = result_prefix + "_tht_matrix.txt";
+    string throughputLinkTestFileName = result_prefix + "_tht_init_matrix.txt";
+    string psrFileName = result_prefix + "_psr_matrix.txt";
+    string psrLinkTestFileName = result_prefix + "_psr_init_matrix.txt";
+    string routingFileName = file_prefix + "_RoutingTable.txt";
+    string outfileName = result_prefix + "_position";
+    string throughputCiFileName = result_prefix + "_tht_ci_matrix.txt";
+    string psrCiFileName = result_prefix + "_psr_ci_matrix.txt";
+    string durationFileName = result_prefix + "_duration_matrix.txt";
+    string linkTestKeyFileName = result_prefix + "_init_key.txt";
+
+    Matrix<double> throughput(N, N, 0);
+    Matrix<double> psr(N, N, 0);
+    vector<Matrix<double>> surveyThroughput, surveyPsr; // 多MCS链路测量：每个MCS一个矩阵
+    
+    // 如果不存在路由文件，则创建并初始化为直接路由
+    if(!fileExists(routingFileName)){
+        InitRouteMatrix(routingFileName, N);
+    }
+    Matrix<int> routingTable = ReadMatrix<int>(routingFileName); // 数据读取
+
+    // 增量模式：在当前路由表上应用修改，只有跳序列改变的节点对需要重新测量
+    vector<Link> changedRoutes;
+    if (incremental) {
+        Matrix<int> oldTable = routingTable.Clone();
+        // 只有 matrix 路由把下一跳 -1 理解为无路由，静态路由表中的每个单元都必须是有效的节点
+        int minNextHop = matrixRouting ? -1 : 0;
+        for (const auto& edit : ReadRouteEdits(config.routeEdits)) {
+            uint16_t i = edit.first.first;
+            uint16_t j = edit.first.second;
+            if (i >= N || j >= N || i == j || edit.second < minNextHop || edit.second >= N) {
+                cerr << "无效的路由修改: " << i << " " << j << " " << edit.second << endl;
+                return result;
+            }
+            routingTable[i][j] = edit.second;
+        }
+        changedRoutes = FindChangedRoutes(oldTable, routingTable);
+        cout << "路由修改影响 " << changedRoutes.size() << " 个源/汇节点对" << endl;
+    }
+
+    // 链路测试结果记录了测试时的物理参数，参数改变后需要重新测试
+    string physicsKey = ResultCache::KeyName(Fnv1a64(ScenarioPhysicsKey(config)));
+    bool linkTestStale = false;
+    if (fileExists(throughputLinkTestFileName) && fileExists(linkTestKeyFileName)) {
+        ifstream keyFile(linkTestKeyFileName);
+        string savedKey;
+        keyFile >> savedKey;
+        linkTestStale = savedKey != physicsKey;
+    }
+    vector<TrafficFlow> trafficFlows;
+    if (traffic) { // 全网负载测试只使用路由表，不需要链路测试结果
+        trafficFlows = ReadTrafficMatrix(config.trafficMatrix, N);
+    }
+    else if (mcsSurvey || config.estimate) {
+        // 多MCS链路测量自身就测量全部链路，结果单独保存；解析估计不需要链路测试，已有的链路测试结果只用于校准
+    }
+    else if(!fileExists(throughputLinkTestFileName) || linkTestStale){//如果没有进行过链路测试的话，先进行测试
+        if (config.autoLinkTest || optimizing) { // 路由优化以链路测试结果作为初始的链路度量
+            cout<<"starting link test..."<<endl;
+            linkTest = true;
+        }
+        // 否则从零矩阵开始，只写入本次测量的单元
+    }
+    else if(reset){//准备重置吞吐率文件 default value is false
+        throughput = ReadMatrix<double>(throughputLinkTestFileName);
+        psr = ReadMatrix<double>(psrLinkTestFileName);
+    }
+    else{
+        throughput = ReadMatrix<double>(throughputFileName);
+        psr = ReadMatrix<double>(psrFileName);
+    }
+
+    // 自适应测量时每个单元的置信区间半宽和实际测量时长另存为矩阵，沿用已有文件中未测量单元的值
+    auto readOrZero = [&](const string& fileName) {
+        Matrix<double> matrix;
+        if (fileExists(fileName)) {
+            matrix = ReadMatrix<double>(fileName);
+        }
+        if (matrix.Rows() != N || matrix.Cols() != N) {
+            matrix = Matrix<double>(N, N, 0);
+        }
+        return matrix;
+    };
+    Matrix<double> throughputCi, psrCi, duration;
+    if (config.adaptive) {
+        throughputCi = readOrZero(throughputCiFileName);
+        psrCi = readOrZero(psrCiFileName);
+        duration = readOrZero(durationFileName);
+    }
+
+    // 本次仿真测量的单元
+    vector<Link> measuredLinks;
+    if (linkTest) {
+        for (uint16_t j = 0; j < N; ++j) {
+            for (uint16_t i = 0; i < N; ++i) {
+                if (i != j) {
+                    measuredLinks.push_back(Link(i, j));
+                }
+            }
+        }
+    } else if (incremental) {
+        measuredLinks = changedRoutes;
+    } else if (optimizing || traffic || mcsSurvey || config.estimate) {
+        // 路由优化、全网负载测试、多MCS链路测量和解析估计的结果单独保存，不改变吞吐率和psr矩阵
+    } else if (sourceNode != sinkNode) {
+        measuredLinks.push_back(Link(sourceNode, sinkNode));
+    }
+
+    // 保存矩阵文件并汇总结果，仿真结束和缓存命中时共用
+    ResultCache cache(config.cacheDir, uint64_t(config.cacheMaxMB) << 20);
+    uint64_t cacheKey = ScenarioCacheKey(config, linkTest, routingTable, measuredLinks);
+    // 由吞吐率和psr矩阵填写结果中的 sourceNode -> sinkNode 和全部链路的平均值
+    auto summarize = [&]() {
+        result.throughput = throughput[config.sourceNode % N][config.sinkNode % N];
+        result.psr = psr[config.sourceNode % N][config.sinkNode % N];
+        double throughputSum = 0;
+        double psrSum = 0;
+        for (uint16_t i = 0; i < N; ++i) {
+            for (uint16_t j = 0; j < N; ++j) {
+                if (i != j) {
+                    throughputSum += throughput[i][j];
+                    psrSum += psr[i][j];
+                }
+            }
+        }
+        if (N > 1) {
+            result.meanThroughput = throughputSum / (N * (N - 1));
+            result.meanPsr = psrSum / (N * (N - 1));
+        }
+    };
+    auto finish = [&](uint32_t flows, uint32_t windows) {
+        if (traffic || mcsSurvey || config.estimate) { // 负载测试、多MCS链路测量和解析估计的结果已经单独保存
+            result.ok = true;
+            result.flows = flows;
+            result.windows = windows;
+            result.wallSeconds = chrono::duration<double>(chrono::steady_clock::now() - wallStart).count();
+            return result;
+        }
+        if (incremental) { // 修改后的路由表与结果一起保存
+            SaveMatrix(routingTable, routingFileName, binaryMatrices, N, seed);
+        }
+        if(linkTest){
+            SaveMatrix(throughput, throughputLinkTestFileName, binaryMatrices, N, seed, cacheKey);
+            SaveMatrix(psr, psrLinkTestFileName, binaryMatrices, N, seed, cacheKey);
+            ofstream keyFile(linkTestKeyFileName);
+            keyFile << physicsKey << endl;
+        }
+        SaveMatrix(throughput, throughputFileName, binaryMatrices, N, seed, cacheKey);
+        SaveMatrix(psr, psrFileName, binaryMatrices, N, seed, cacheKey);
+        if (config.adaptive) {
+            SaveMatrix(throughputCi, throughputCiFileName, binaryMatrices, N, seed, cacheKey);
+            SaveMatrix(psrCi, psrCiFileName, binaryMatrices, N, seed, cacheKey);
+            SaveMatrix(duration, durationFileName, binaryMatrices, N, seed, cacheKey);
+        }
+
+        result.ok = true;
+        result.flows = flows;
+        result.windows = windows;
+        summarize();
+        result.wallSeconds = chrono::duration<double>(chrono::steady_clock::now() - wallStart).count();
+        return result;
+    };
+
+    CachedResult cached;
+    // 路由优化的结果取决于仿真过程中的选路，全网负载测试和多MCS链路测量的结果不在矩阵中，都不使用缓存；
+    // 开启跟踪或时间序列输出的运行需要真正运行仿真，同样不使用缓存
+    bool useCache = cache.Enabled() && !optimizing && !traffic && !mcsSurvey && !config.estimate &&
+                    config.traceRing == 0 && config.streamBin == 0;
+    if (useCache && cache.Lookup(cacheKey, &cached)) {
+        for (const auto& cell : cached.cells) {
+            throughput[cell.i][cell.j] = cell.throughput;
+            psr[cell.i][cell.j] = cell.psr;
+            if (config.adaptive) {
+                throughputCi[cell.i][cell.j] = cell.throughputCi;
+                psrCi[cell.i][cell.j] = cell.psrCi;
+                duration[cell.i][cell.j] = cell.duration;
+            }
+        }
+        cout << "使用缓存的仿真结果 " << ResultCache::KeyName(cacheKey) << endl;
+        result.cacheHit = true;
+        result.simulatedSeconds = cached.simulatedSeconds;
+        return finish(cached.flows, cached.windows);
+    }
+    if (incremental && measuredLinks.empty()) { // 所有路径都没有变化，不需要运行仿真
+        return finish(0, 0);
+    }
+
+    // 创建Wi-Fi和干扰节点
+    profiler.Begin("createNodes");
+    vector<NodeContainer> nodeContainers;
+    vector<string> nodeTypes;
+    NodeContainer nodes, interferingNodes;
+    nodes.Create(N);
+    interferingNodes.Create(M);
+   
+    nodeContainers.insert(nodeContainers.end(), {nodes, interferingNodes});
+    nodeTypes.insert(nodeTypes.end(), {"Wi-Fi", "Interference"});
+    profiler.SetNodeCategory(nodes, "wifi");
+    profiler.SetNodeCategory(interferingNodes, "interference");
+
+    profiler.Begin("channel");
+    SpectrumWifiPhyHelper wifiPhy;
+    // 信道设置
+    // single 和 grid 模式下所有发送者使用同一个频谱模型，信道不需要转换功率谱密度
+    bool singleModel = config.spectrumChannel != "multi";
+    Ptr<SpectrumChannel> spectrumChannel;
+    Ptr<GridSpectrumChannel> gridChannel;
+    if (config.spectrumChannel == "grid") {
+        gridChannel = CreateObject<GridSpectrumChannel>();
+        gridChannel->SetCutoff(config.rxCutoff);
+        gridChannel->SetCellSize(config.gridCellSize);
+        spectrumChannel = gridChannel;
+    } else if (singleModel) {
+        spectrumChannel = CreateObject<SingleModelSpectrumChannel>();
+    } else {
+        spectrumChannel = CreateObject<MultiModelSpectrumChannel>();
+    }
+    // 传播时延模型
+    Ptr<ConstantSpeedPropagationDelayModel> delayModel =
+        CreateObject<ConstantSpeedPropagationDelayModel>();
+    spectrumChannel->SetPropagationDelayModel(delayModel);
+    // 传播损失模型
+    Ptr<PropagationLossModel> lossModel;
+    Ptr<FriisPropagationLossModel> friisLossModel = CreateObject<FriisPropagationLossModel>();
+    friisLossModel->SetFrequency(2412 * 1e6);//
+    Ptr<CachedPropagationLossModel> cachedLossModel;
+    if (cachedLoss) { // 节点位置固定，损耗只需要计算一次
+        cachedLossModel = CreateObject<CachedPropagationLossModel>();
+        cachedLossModel->SetInnerModel(friisLossModel);
+        lossModel = cachedLossModel;
+    } else {
+        lossModel = friisLossModel;
+    }
+    spectrumChannel->AddPropagationLossModel(lossModel);
+    profiler.ConnectChannel(spectrumChannel);
+    
+    wifiPhy.SetChannel(spectrumChannel);
+    wifiPhy.Set("RxNoiseFigure", DoubleValue(config.rxNoiseFigure));
+    wifiPhy.Set("ChannelSettings",
+                    StringValue(string("{0, ") + (channelBonding ? "40, " : "20, ") +
+                    (frequencyMode == 2.4 ? "BAND_2_4GHZ" : "BAND_5GHZ") + ", 0}"));
+
+    // 创建一个Wi-Fi网络
+    profiler.Begin("wifiInstall");
+    WifiHelper wifi;
+    Ssid ssid = Ssid("ns3-80211n");
+    wifi.SetStandard(WIFI_STANDARD_80211n);
+    wifi.SetRemoteStationManager("ns3::ConstantRateWifiManager", 
+                                "DataMode",StringValue(modes[mcsIndex]),
+                                "ControlMode",StringValue(modes[mcsIndex]));
+    // 创建MAC层属性
+    WifiMacHelper adhocMac;
+    adhocMac.SetType("ns3::AdhocWifiMac", "Ssid", SsidValue(ssid));// adhocmac
+
+    NetDeviceContainer wifiAdHocDevices = wifi.Install(wifiPhy, adhocMac, nodes);
+    Config::Set("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/HtConfiguration/"
+                "ShortGuardIntervalSupported", BooleanValue(false));
+    
+    // 获取频率
+    Ptr<NetDevice> devicePtr = wifiAdHocDevices.Get(0);
+    Ptr<WifiPhy> wifiPhyPtr = devicePtr->GetObject<WifiNetDevice>()->GetPhy();
+    uint16_t frequency = wifiPhyPtr->GetFrequency();
+
+    // 环形缓冲区跟踪，代替 wifiPhy.EnablePcap/EnableAscii 的全程跟踪
+    PacketTraceRing traceRing(config.traceRing, config.traceSample, config.tracePsrThreshold,
+        config.traceMaxDumps, result_prefix);
+    traceRing.Install(wifiAdHocDevices);
+    if (config.traceDumpTime >= 0) {
+        traceRing.ScheduleDump(config.traceDumpTime);
+    }
+    
+    // 创建移动模型
+    profiler.Begin("mobility");
+    MobilityHelper mobility;
+    RngSeedManager::SetSeed(seed);
+    Ptr<UniformRandomVariable> xVal = CreateObject<UniformRandomVariable> ();
+    xVal->SetAttribute ("Min", DoubleValue (minX));
+    xVal->SetAttribute ("Max", DoubleValue (maxX));
+    Ptr<UniformRandomVariable> yVal = CreateObject<UniformRandomVariable> ();
+    yVal->SetAttribute ("Min", DoubleValue (minY));
+    yVal->SetAttribute ("Max", DoubleValue (maxY));
+
+    // 设置RandomRectanglePositionAllocator的属性
+    mobility.SetPositionAllocator ("ns3::RandomRectanglePositionAllocator",
+                                  "X", PointerValue (xVal),
+                                  "Y", PointerValue (yVal));
+
+    mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+    mobility.Install(nodes);
+    mobility.Install(interferingNodes);
+    if (cachedLossModel) {
+        cachedLossModel->Precompute(NodeContainer(nodes, interferingNodes));
+    }
+
+    profiler.Begin("plotPositions");
+    PlotMultipleNodePositionsGnuplot(nodeContainers, nodeTypes, seed, outfileName); //绘制节点分布图
+
+    if (config.estimate) { // 只需要节点位置和 PHY 参数，不安装干扰节点和协议栈，不运行仿真
+        profiler.Begin("estimate");
+        bool calibrate = fileExists(throughputLinkTestFileName) && fileExists(psrLinkTestFileName) && !linkTestStale;
+        EstimateLinks(config, wifiPhyPtr, nodes, interferingNodes, lossModel, waveformPower, packetSize, calibrate,
+            &throughput, &psr);
+        profiler.Finish();
+        Simulator::Destroy();
+        summarize();
+        profiler.WriteJson(result_prefix + "_profile.json", result_prefix);
+        return finish(0, 0);
+    }
+
+    // Configure waveform generator
+    profiler.Begin("interference");
+    NetDeviceContainer waveformGeneratorDevices;
+    if (interferenceMode == INTERFERENCE_WAVEFORM) {
+        Ptr<SpectrumValue> wgPsd;
+        if (singleModel) { // 复用 Wi-Fi PHY 当前信道的频谱模型
+            Ptr<SpectrumWifiPhy> spectrumPhy = DynamicCast<SpectrumWifiPhy>(wifiPhyPtr);
+            wgPsd = CreateInterfererPsd(spectrumPhy->GetCurrentInterface()->GetRxSpectrumModel(),
+                frequency, waveformPower);
+        } else {
+            wgPsd = Create<SpectrumValue>(generator_Spectrum_Model(frequency));
+            *wgPsd = waveformPower / 20e6; // PSD spread across 20 MHz
+        }
+        WaveformGeneratorHelper waveformGeneratorHelper;
+        waveformGeneratorHelper.SetChannel(spectrumChannel);
+        waveformGeneratorHelper.SetTxPowerSpectralDensity(wgPsd);
+        waveformGeneratorHelper.SetPhyAttribute("Period", TimeValue(Seconds(0.0007)));
+        waveformGeneratorHelper.SetPhyAttribute("DutyCycle", DoubleValue(1));
+        waveformGeneratorDevices = waveformGeneratorHelper.Install(interferingNodes);
+    }
+    // psd 模式下不安装波形发生器，干扰功率在这里一次性折算到各 PHY 的噪声中
+    InterferenceController interference(interferenceMode, interferingNodes, waveformGeneratorDevices,
+        wifiAdHocDevices, lossModel, waveformPower, config.rxNoiseFigure);
+    // psd 模式不模拟能量检测：干扰达到门限时波形模式下信道一直忙，而 psd 模式只降低 SINR，两者的结果不可比
+    if (interferenceMode == INTERFERENCE_PSD && interference.MaxRxPowerDbm() >= wifiPhyPtr->GetCcaEdThreshold()) {
+        cerr << "psd 干扰模式下 Wi-Fi 节点处的干扰总功率 " << interference.MaxRxPowerDbm()
+             << " dBm 达到能量检测门限 " << wifiPhyPtr->GetCcaEdThreshold() << " dBm，请使用 waveform 模式" << endl;
+        Simulator::Destroy();
+        return result;
+    }
+    if (!config.fastForward) {
+        Simulator::Schedule(Seconds(0.002), &InterferenceController::SetAllActive, &interference, true);
+    }
+
+    // 配置路由和安装网络协议
+    profiler.Begin("internetStack");
+    InternetStackHelper stack;
+    Ptr<MatrixRoutingTable> routingMatrix;
+    if (matrixRouting) { // 所有节点共享同一个下一跳矩阵
+        routingMatrix = Create<MatrixRoutingTable>(nodes);
+        stack.SetRoutingHelper(MatrixRoutingHelper(routingMatrix));
+    }
+
+    stack.Install(nodes);
+    // 重复仿真：节点位置已经确定，之后 Wi-Fi 设备(PHY、MAC、速率管理)和协议栈(ARP)的随机变量
+    // 按设备和组件使用固定编号的子流，只由 seed 和 run 决定，与对象创建顺序无关。
+    // 同一 run 下只改变干扰功率的两次仿真因此使用相同的随机数(公共随机数)
+    if (config.run > 0) {
+        RngSeedManager::SetRun(config.run);
+        int64_t stream = 0;
+        stream += wifi.AssignStreams(wifiAdHocDevices, stream);
+        stack.AssignStreams(nodes, stream);
+    }
+    Ipv4AddressHelper address;
+    address.SetBase("10.0.0.0", "255.255.0.0"); // 支持超过 254 个节点
+    Ipv4InterfaceContainer ip = address.Assign(wifiAdHocDevices);
+
+    profiler.Begin("routing");
+    Ipv4StaticRoutingHelper staticRouting;
+    if (matrixRouting) {
+        routingMatrix->SetAddresses(ip);
+        if (updateRoutes) {
+            routingMatrix->SetTable(routingTable);
+        } else {
+            routingMatrix->SetDirectTable();
+        }
+        if (!config.routeSwapFile.empty()) { // Matrix 只能移动，事件中通过 shared_ptr 持有
+            auto swapTable = make_shared<Matrix<int>>(ReadMatrix<int>(config.routeSwapFile));
+            Simulator::Schedule(Seconds(config.routeSwapTime), [routingMatrix, swapTable]() {
+                routingMatrix->SetTable(*swapTable);
+            });
+        }
+    } else {
+        InitializeDirectRoutes(nodes, staticRouting, ip);//没必要保存到路由表中
+        if(updateRoutes){ // default value is true
+            UpdateStaticRoutingTable(nodes, staticRouting, ip, routingTable);
+        }
+        stack.SetRoutingHelper(staticRouting);
+    }
+
+    // Calculate Throughput using Flowmonitor
+    profiler.Begin("flowMonitor");
+    FlowMonitorHelper flowmon;
+    Ptr<FlowMonitor> monitor;
+    Ptr<Ipv4FlowClassifier> classifier;
+    FlowCounterProbe probe;
+    if (!config.flowProbe) {
+        monitor = flowmon.InstallAll();
+        classifier = DynamicCast<Ipv4FlowClassifier>(flowmon.GetClassifier());
+    }
+    FlowStatsIndex flowIndex(monitor, classifier, config.flowProbe ? &probe : nullptr);
+    StreamingFlowStats streamStats(&flowIndex, config.streamBin, config.streamFormat, result_prefix, N, seed);
+    ApplicationContainer apps_source;
+    ApplicationContainer apps_sink;
+    uint32_t count = 0;
+    uint16_t port = 9;
+    // 初始化延迟。空闲的网络中没有需要等待的状态(ARP在第一条流开始时才解析)，
+    // 快进模式下只保留不超过 kFastForwardWarmup 的初始化时间
+    double initialDelay = config.fastForward ? min(config.warmup, kFastForwardWarmup) : config.warmup;
+    double startTime = initialDelay;
+    double stopTime = startTime + simulationTime;
+
+    profiler.Begin("applications");
+    PacketSinkHelper sink("ns3::UdpSocketFactory", InetSocketAddress(Ipv4Address::GetAny(), port));
+    Ipv4Address sinkAddress; // 用来存储sink节点的地址
+    uint32_t windows = 0; // 已占用的测量时隙数量
+    // 测量结果写入的矩阵，多MCS链路测量时指向当前MCS的矩阵
+    Matrix<double>* windowThroughput = &throughput;
+    Matrix<double>* windowPsr = &psr;
+    double flowRate = datarate; // 数据流的发送速率(Mbps)，多MCS链路测量时为当前MCS的物理层速率
+    // 用于创建数据流的通用函数
+    auto createDataFlow = [&](uint16_t source, uint16_t sink) {
+        sinkAddress = ip.GetAddress(sink); // 获取sink节点的地址
+        OnOffHelper onoff("ns3::UdpSocketFactory", InetSocketAddress(sinkAddress, port));
+        onoff.SetConstantRate(DataRate(to_string(flowRate)+"Mb/s"), packetSize); // 设置数据生成速率
+        onoff.SetAttribute("StartTime", TimeValue(Seconds(startTime)));
+        onoff.SetAttribute("StopTime", TimeValue(Seconds(stopTime))); // 设置开始和结束时间
+        ApplicationContainer app = onoff.Install(nodes.Get(source));
+        apps_source.Add(app);
+        uint32_t handle = flowIndex.Register(ip.GetAddress(source), sinkAddress, port, app.Get(0));
+        streamStats.Track(handle, source, sink, startTime);
+        Simulator::Schedule(Seconds(stopTime + T / 2),
+            &CalculateThroughput, &flowIndex, handle, windowThroughput, windowPsr, source, sink, &traceRing);
+    };
+    // 快进模式：干扰节点提前 kInterferenceLead 秒打开，在 close 时刻关闭，close 为负表示不再关闭
+    auto gateInterference = [&](double open, double close) {
+        if (!config.fastForward) {
+            return;
+        }
+        Simulator::Schedule(Seconds(open - kInterferenceLead), &InterferenceController::OpenWindow, &interference);
+        if (close >= 0) {
+            Simulator::Schedule(Seconds(close), &InterferenceController::CloseWindow, &interference);
+        }
+    };
+    // 进入下一个测量时隙。干扰节点在本时隙的结果读取之后关闭，
+    // 此时 MAC 队列中剩余的分组已达到 MaxDelay(500 ms)被丢弃，间隔中不会再有 Wi-Fi 传输
+    auto nextWindow = [&]() {
+        gateInterference(startTime, stopTime + T / 2);
+        windows++;
+        startTime = stopTime + T;
+        stopTime = startTime + simulationTime;
+    };
+
+    // 自适应测量：各时隙的时长在仿真过程中才确定，先记录全部时隙，再由 survey 依次调度
+    AdaptiveLinkSurvey survey(adaptiveOptions, &flowIndex, &throughput, &psr,
+        &throughputCi, &psrCi, &duration, T);
+    // 测量一个时隙内的全部链路
+    auto measureWindow = [&](const vector<Link>& slot) {
+        count += slot.size();
+        if (config.adaptive) {
+            survey.AddWindow(slot);
+            return;
+        }
+        for (const auto& link : slot) {
+            createDataFlow(link.first, link.second);
+        }
+        nextWindow();
+    };
+
+    FlowSetupContext flowSetup{N, nodes, sink, apps_sink, startTime, windowThroughput, windowPsr, flowRate,
+        measureWindow, lossModel, wifiPhyPtr->GetTxPowerStart(), csThreshold};
+    if (linkTest) {
+        SetupLinkTestFlows(flowSetup, concurrentLinkTest);
+    } else if (incremental) {
+        SetupIncrementalFlows(flowSetup, measuredLinks);
+    } else if (optimizing) { // 节点对的流由路由优化在每一轮中创建
+        InstallAllSinks(flowSetup);
+    } else if (mcsSurvey) {
+        SetupMcsSurveyFlows(flowSetup, concurrentLinkTest, surveyMcs, T, &surveyThroughput, &surveyPsr);
+    } else if (traffic) {
+        gateInterference(startTime, -1);
+        count = SetupTrafficFlows(flowSetup, ip, port, packetSize, config.trafficDuration, &trafficFlows, &flowIndex,
+            &streamStats, &apps_source);
+        windows = 1;
+    } else {
+        SetupSingleFlow(flowSetup, sourceNode, sinkNode);
+    }
+    if (config.flowProbe) { // 所有接收应用都已安装，路由优化和自适应测量在运行中创建的流也会用到
+        probe.AddSinks(apps_sink);
+    }
+    // 路由优化从链路测量之后开始，初始的链路度量为链路测试结果
+    RouteOptimizer::Options optimizerOptions;
+    optimizerOptions.metric = routeMetric;
+    optimizerOptions.rounds = config.optimizeRounds;
+    optimizerOptions.damping = config.optimizeDamping;
+    optimizerOptions.duration = simulationTime;
+    optimizerOptions.gap = T;
+    optimizerOptions.outputPrefix = result_prefix;
+    optimizerOptions.binaryMatrices = binaryMatrices;
+    optimizerOptions.seed = seed;
+    vector<Link> optimizerPairs;
+    for (uint16_t j = 0; j < N; ++j) {
+        for (uint16_t i = 0; i < N; ++i) {
+            if (i != j && (config.optimizePairs == "all" || (i == config.sourceNode && j == config.sinkNode))) {
+                optimizerPairs.push_back(Link(i, j));
+            }
+        }
+    }
+    RouteOptimizer optimizer(optimizerOptions, &flowIndex, optimizerPairs);
+    Matrix<double> linkThroughput, linkPsr;
+    if (optimizing && !linkTest) {
+        linkThroughput = ReadMatrix<double>(throughputLinkTestFileName);
+        linkPsr = ReadMatrix<double>(psrLinkTestFileName);
+    }
+
+    // 启动仿真器
+    if (config.fastForward) { // 自适应测量和路由优化的时隙在仿真过程中才确定，由它们在每个时隙前后通知
+        auto openWindow = [&](double delay) {
+            Simulator::Schedule(Seconds(delay - kInterferenceLead), &InterferenceController::OpenWindow,
+                                &interference);
+        };
+        auto closeWindow = [&]() { interference.CloseWindow(); };
+        survey.SetWindowGate(openWindow, closeWindow);
+        optimizer.SetWindowGate(openWindow, closeWindow);
+    }
+    if (optimizing) {
+        optimizer.Start(startTime, linkTest ? &throughput : &linkThroughput, linkTest ? &psr : &linkPsr,
+            [&](const Matrix<int>& routes) {
+                if (matrixRouting) {
+                    routingMatrix->SetTable(routes);
+                } else {
+                    UpdateStaticRoutingTable(nodes, staticRouting, ip, routes);
+                }
+            },
+            [&](uint16_t source, uint16_t sink, double flowDuration) {
+                OnOffHelper onoff("ns3::UdpSocketFactory", InetSocketAddress(ip.GetAddress(sink), port));
+                onoff.SetConstantRate(DataRate(to_string(datarate)+"Mb/s"), packetSize);
+                onoff.SetAttribute("StartTime", TimeValue(Seconds(0)));
+                onoff.SetAttribute("StopTime", TimeValue(Seconds(flowDuration)));
+                ApplicationContainer app = onoff.Install(nodes.Get(source));
+                apps_source.Add(app);
+                uint32_t handle = flowIndex.Register(ip.GetAddress(source), ip.GetAddress(sink), port, app.Get(0));
+                streamStats.Track(handle, source, sink, Simulator::Now().GetSeconds());
+                return handle;
+            });
+    } else if (config.adaptive) {
+        // 流在时隙开始时才创建，StartTime 相对于创建时刻；StopTime 作为最长测量时间的兜底
+        survey.Start(startTime, [&](uint16_t source, uint16_t sink) {
+            OnOffHelper onoff("ns3::UdpSocketFactory", InetSocketAddress(ip.GetAddress(sink), port));
+            onoff.SetConstantRate(DataRate(to_string(datarate)+"Mb/s"), packetSize);
+            onoff.SetAttribute("StartTime", TimeValue(Seconds(0)));
+            onoff.SetAttribute("StopTime", TimeValue(Seconds(adaptiveOptions.maxTime + adaptiveOptions.interval)));
+            ApplicationContainer app = onoff.Install(nodes.Get(source));
+            apps_source.Add(app);
+            uint32_t handle = flowIndex.Register(ip.GetAddress(source), ip.GetAddress(sink), port, app.Get(0));
+            streamStats.Track(handle, source, sink, Simulator::Now().GetSeconds());
+            return AdaptiveLinkSurvey::Flow{app.Get(0), handle};
+        });
+        windows = survey.GetNWindows();
+    } else if (traffic) {
+        Simulator::Stop(Seconds(startTime + config.trafficDuration + T)); // 留出时间接收在途的分组
+    } else {
+        Simulator::Stop(Seconds(windows*(T+simulationTime)+initialDelay));
+    }
+    streamStats.Start();
+    auto runStart = chrono::steady_clock::now();
+    result.setupSeconds = chrono::duration<double>(runStart - wallStart).count();
+    profiler.Begin("run");
+    Simulator::Run();
+    profiler.Finish();
+    result.runSeconds = chrono::duration<double>(chrono::steady_clock::now() - runStart).count();
+    result.events = Simulator::GetEventCount();
+    result.simulatedSeconds = Simulator::Now().GetSeconds();
+    if (cachedLossModel) {
+        result.lossCacheHits = cachedLossModel->GetHits();
+        result.lossCacheMisses = cachedLossModel->GetMisses();
+        NS_LOG_INFO("传播损耗缓存命中 " << result.lossCacheHits << " 次, 未命中 "
+            << result.lossCacheMisses << " 次");
+    }
+    if (gridChannel) {
+        result.deliveries = gridChannel->GetDeliveries();
+        result.culledDeliveries = gridChannel->GetCulled();
+        NS_LOG_INFO("grid 信道共 " << gridChannel->GetTransmissions() << " 次发送, 投递 "
+            << result.deliveries << " 次, 跳过 " << result.culledDeliveries << " 次");
+    }
+    if (traceRing.GetSuppressed() > 0) {
+        cout << "跟踪缓冲区已写出 " << traceRing.GetDumps() << " 次, 另有 " << traceRing.GetSuppressed()
+             << " 次触发超过 --traceMaxDumps 而没有写出" << endl;
+    }
+    streamStats.Close();
+    vector<FlowSample> trafficSamples;
+    if (traffic) {
+        trafficSamples = CollectTrafficSamples(flowIndex, trafficFlows);
+    }
+    profiler.Begin("destroy");
+    Simulator::Destroy();
+
+    if (useCache) {
+        cached.flows = count;
+        cached.windows = windows;
+        cached.simulatedSeconds = result.simulatedSeconds;
+        cached.runSeconds = result.runSeconds;
+        for (const auto& link : measuredLinks) {
+            CachedCell cell;
+            cell.i = link.first;
+            cell.j = link.second;
+            cell.throughput = throughput[cell.i][cell.j];
+            cell.psr = psr[cell.i][cell.j];
+            if (config.adaptive) {
+                cell.throughputCi = throughputCi[cell.i][cell.j];
+                cell.psrCi = psrCi[cell.i][cell.j];
+                cell.duration = duration[cell.i][cell.j];
+            }
+            cached.cells.push_back(cell);
+        }
+        cache.Store(cacheKey, cached);
+    }
+    profiler.Begin("saveResults");
+    if (mcsSurvey) {
+        SaveMcsSurvey(surveyMcs, surveyThroughput, surveyPsr, result_prefix, binaryMatrices, N, seed);
+    }
+    if (traffic) {
+        TrafficSummary summary = SaveTrafficResults(trafficFlows, trafficSamples, config.trafficDuration, N,
+            result_prefix, binaryMatrices, seed);
+        result.goodput = summary.goodput;
+        result.meanThroughput = summary.flows > 0 ? summary.goodput / summary.flows : 0;
+        result.meanPsr = summary.meanPsr;
+    }
+    finish(count + optimizer.GetFlows(), windows + optimizer.GetFlows());
+    profiler.End();
+    profiler.WriteJson(result_prefix + "_profile.json", result_prefix);
+    return result;
+}
+#endif // WIFI_SCENARIO_H
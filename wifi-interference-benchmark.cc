@@ -0,0 +1,250 @@
+/*
+    仿真规模的基准测试：在 N(无线节点数)、M(干扰节点数)、链路测试/单条流、干扰功率组成的网格上
+    逐点运行 wifi-interference 的场景，记录每个点的墙钟时间、每秒墙钟时间推进的仿真时间、
+    执行的事件数、峰值内存，以及场景搭建和 Simulator::Run 各自的耗时。
+    结果保存为CSV文件，并与同一台机器上之前保存的基线(--baseline，--updateBaseline=true 时写入)比较，发现性能退化。
+    默认的网格很小，几分钟内即可完成；N 达到数百的大网格需要通过 --benchN/--benchM 显式给出。
+*/
+#include "ParameterSweep.h"
+
+using namespace ns3;
+using namespace std;
+
+// 一个基准测试点
+struct BenchmarkPoint
+{
+    string name; // 与基线比较时使用的键
+    ScenarioConfig config;
+    string mode;
+    string channel;
+};
+
+// 一个基准测试点的测量结果
+struct BenchmarkRecord
+{
+    string status;
+    uint32_t flows = 0;
+    uint64_t events = 0;
+    double simulatedSeconds = 0;
+    double wallSeconds = 0;
+    double setupSeconds = 0;
+    double runSeconds = 0;
+    double peakRssMB = 0;
+};
+
+// 读取之前保存的基准测试结果，按测试点名称索引
+map<string, BenchmarkRecord> ReadBenchmarkFile(const string &fileName)
+{
+    map<string, BenchmarkRecord> records;
+    ifstream input(fileName);
+    if (!input.is_open()) {
+        throw runtime_error("File " + fileName + " not found");
+    }
+    string line;
+    getline(input, line); // 表头
+    while (getline(input, line)) {
+        vector<string> fields = SplitString(line, ',');
+        if (fields.size() < 15) {
+            continue;
+        }
+        BenchmarkRecord record;
+        record.status = fields[5];
+        record.flows = stoul(fields[6]);
+        record.events = stoull(fields[7]);
+        record.simulatedSeconds = stod(fields[8]);
+        record.wallSeconds = stod(fields[9]);
+        record.setupSeconds = stod(fields[10]);
+        record.runSeconds = stod(fields[11]);
+        record.peakRssMB = stod(fields[14]);
+        records[fields[0]] = record;
+    }
+    return records;
+}
+
+int main(int argc, char* argv[])
+{
+    ScenarioConfig base;
+    base.outputDir = "txtfiles/benchmark/";
+    string nodes = "10,20";
+    string interferers = "0,10";
+    string benchModes = "single,linkTest";
+    string powers = "10";
+    string channels = "multi";
+    string output = "";
+    string baseline = "";
+    bool updateBaseline = false;
+    double tolerance = 0.2;
+    double minSeconds = 1;
+    uint32_t jobs = 1;
+    uint32_t timeout = 1800;
+
+    CommandLine cmd(__FILE__);
+    AddScenarioOptions(cmd, base);
+    cmd.AddValue("benchN", "无线节点数量列表", nodes);
+    cmd.AddValue("benchM", "干扰节点数量列表", interferers);
+    cmd.AddValue("benchModes", "测量方式列表：single(单条流) 和/或 linkTest(链路测试)", benchModes);
+    cmd.AddValue("benchPowers", "干扰功率列表", powers);
+    cmd.AddValue("benchChannels", "频谱信道列表：multi 和/或 single，同时给出时比较两者每秒执行的事件数", channels);
+    cmd.AddValue("benchOutput", "基准测试结果文件，默认为 outputDir/benchmark.csv", output);
+    cmd.AddValue("baseline", "与之比较的基准测试结果文件，默认为 outputDir/benchmark_baseline.csv", baseline);
+    cmd.AddValue("updateBaseline", "运行结束后用本次结果覆盖基线文件", updateBaseline);
+    cmd.AddValue("tolerance", "墙钟时间或峰值内存超过基线的比例大于该值时视为退化", tolerance);
+    cmd.AddValue("minSeconds", "基线墙钟时间小于该值(秒)的测试点只比较内存，避免计时噪声", minSeconds);
+    cmd.AddValue("jobs", "并行进程数，默认为1以免测试点之间互相影响计时", jobs);
+    cmd.AddValue("timeout", "单个测试点的最长墙钟时间(秒)，0表示不限制", timeout);
+    cmd.Parse(argc, argv);
+
+    // 基准测试只测量仿真本身
+    base.cacheDir = "";
+    if (output.empty()) {
+        output = base.outputDir + "benchmark.csv";
+    }
+    // 计时只在同一台机器上可比，基线保存在输出目录中而不随代码提交
+    if (baseline.empty()) {
+        baseline = base.outputDir + "benchmark_baseline.csv";
+    }
+    fs::create_directories(base.outputDir);
+
+    vector<BenchmarkPoint> points;
+    for (const auto &n : SplitString(nodes, ',')) {
+        for (const auto &m : SplitString(interferers, ',')) {
+            for (const auto &mode : SplitString(benchModes, ',')) {
+                for (const auto &power : SplitString(powers, ',')) {
+                    for (const auto &channel : SplitString(channels, ',')) {
+                        if (mode != "single" && mode != "linkTest") {
+                            cerr << "未知的测量方式 " << mode << endl;
+                            return 1;
+                        }
+                        BenchmarkPoint point;
+                        // 默认的 multi 信道不加后缀，与之前保存的基线保持一致
+                        point.name = "N" + n + "_M" + m + "_" + mode + "_power" + power +
+                                     (channel == "multi" ? "" : "_" + channel);
+                        point.mode = mode;
+                        point.channel = channel;
+                        // 单条流的测试点不做自动的链路测试，只测量这一条流
+                        string linkTest = mode == "linkTest" ? "true" : "false";
+                        point.config = ApplyScenarioOptions(base, {"N=" + n, "M=" + m, "power=" + power,
+                                                                   "linkTest=" + linkTest, "autoLinkTest=" + linkTest,
+                                                                   "spectrumChannel=" + channel});
+                        point.config.tag = point.name;
+                        point.config.sourceNode = 0;
+                        point.config.sinkNode = point.config.N - 1;
+                        points.push_back(point);
+                    }
+                }
+            }
+        }
+    }
+
+    vector<ScenarioConfig> configs;
+    for (const auto &point : points) {
+        const ScenarioConfig &config = point.config;
+        string routingFileName = ScenarioFilePrefix(config) + "_RoutingTable.txt";
+        if (!fileExists(routingFileName)) {
+            InitRouteMatrix(routingFileName, config.N);
+        }
+        configs.push_back(config);
+    }
+
+    map<string, BenchmarkRecord> baselineRecords;
+    bool hasBaseline = fileExists(baseline);
+    if (hasBaseline) {
+        baselineRecords = ReadBenchmarkFile(baseline);
+    } else {
+        cout << "基线文件 " << baseline << " 不存在，本次不比较；使用 --updateBaseline=true 保存本次结果作为基线" << endl;
+    }
+
+    ofstream outputFile(output);
+    if (!outputFile.is_open()) {
+        throw runtime_error("Unable to open file " + output);
+    }
+    outputFile << "name,N,M,mode,power,status,flows,events,simulatedSeconds,wallSeconds,setupSeconds,"
+                  "runSeconds,simulatedPerWallSecond,eventsPerSecond,peakRssMB" << endl;
+    cout << "基准测试共 " << points.size() << " 个测试点" << endl;
+
+    uint32_t regressions = 0;
+    map<string, BenchmarkRecord> records;
+    RunScenariosInWorkers(configs, jobs, base.outputDir + "logs/",
+        [&](size_t index, const string &row, const struct rusage &usage) {
+            const BenchmarkPoint &point = points[index];
+            BenchmarkRecord record;
+            vector<string> fields = SplitString(row, ',');
+            record.status = fields.empty() ? row : fields[0];
+            if (fields.size() >= 13) {
+                record.flows = stoul(fields[1]);
+                record.simulatedSeconds = stod(fields[3]);
+                record.wallSeconds = stod(fields[4]);
+                record.runSeconds = stod(fields[5]);
+                record.setupSeconds = stod(fields[11]);
+                record.events = stoull(fields[12]);
+            }
+            record.peakRssMB = usage.ru_maxrss / 1024.0; // Linux 下 ru_maxrss 的单位为KB
+            double simulatedPerWall = record.wallSeconds > 0 ? record.simulatedSeconds / record.wallSeconds : 0;
+            double eventsPerSecond = record.runSeconds > 0 ? record.events / record.runSeconds : 0;
+            records[point.name] = record;
+            outputFile << point.name << "," << point.config.N << "," << point.config.M << "," << point.mode << ","
+                       << point.config.power << "," << record.status << "," << record.flows << ","
+                       << record.events << "," << record.simulatedSeconds << "," << record.wallSeconds << ","
+                       << record.setupSeconds << "," << record.runSeconds << "," << simulatedPerWall << ","
+                       << eventsPerSecond << "," << record.peakRssMB << endl;
+            cout << point.name << ": " << record.status << ", 墙钟 " << record.wallSeconds << " s (搭建 "
+                 << record.setupSeconds << " s), " << record.events << " 个事件, 峰值内存 "
+                 << record.peakRssMB << " MB" << endl;
+
+            auto it = baselineRecords.find(point.name);
+            if (it == baselineRecords.end()) {
+                return;
+            }
+            const BenchmarkRecord &old = it->second;
+            if (record.status != "ok" && old.status == "ok") {
+                regressions++;
+                cout << "  退化: 基线中该测试点成功完成，本次为 " << record.status << endl;
+                return;
+            }
+            if (old.wallSeconds >= minSeconds && record.wallSeconds > old.wallSeconds * (1 + tolerance)) {
+                regressions++;
+                cout << "  退化: 墙钟时间 " << old.wallSeconds << " s -> " << record.wallSeconds << " s" << endl;
+            }
+            if (old.peakRssMB > 0 && record.peakRssMB > old.peakRssMB * (1 + tolerance)) {
+                regressions++;
+                cout << "  退化: 峰值内存 " << old.peakRssMB << " MB -> " << record.peakRssMB << " MB" << endl;
+            }
+        }, timeout);
+    outputFile.close();
+    cout << "基准测试结果保存在 " << output << endl;
+
+    // 同一测试点在 single 与 multi 信道下的比较，同时写入 spectrum_gain.csv
+    ofstream gainFile;
+    for (const auto &point : points) {
+        if (point.channel == "multi") {
+            continue;
+        }
+        string multiName = point.name.substr(0, point.name.size() - point.channel.size() - 1);
+        auto fast = records.find(point.name);
+        auto slow = records.find(multiName);
+        if (fast == records.end() || slow == records.end() || fast->second.status != "ok" ||
+            slow->second.status != "ok" || fast->second.runSeconds <= 0 || slow->second.runSeconds <= 0) {
+            continue;
+        }
+        double fastRate = fast->second.events / fast->second.runSeconds;
+        double slowRate = slow->second.events / slow->second.runSeconds;
+        if (!gainFile.is_open()) {
+            gainFile.open(base.outputDir + "spectrum_gain.csv");
+            gainFile << "name,N,M,channel,eventsPerSecond,multiEventsPerSecond,gain,runSeconds,multiRunSeconds" << endl;
+        }
+        gainFile << multiName << "," << point.config.N << "," << point.config.M << "," << point.channel << ","
+                 << fastRate << "," << slowRate << "," << (slowRate > 0 ? fastRate / slowRate : 0) << ","
+                 << fast->second.runSeconds << "," << slow->second.runSeconds << endl;
+        cout << multiName << ": " << point.channel << " 信道每秒执行 " << fastRate << " 个事件, multi 信道 "
+             << slowRate << " 个, 提升 " << (slowRate > 0 ? fastRate / slowRate : 0) << " 倍; Simulator::Run 耗时 "
+             << slow->second.runSeconds << " s -> " << fast->second.runSeconds << " s" << endl;
+    }
+    if (hasBaseline) {
+        cout << "与基线 " << baseline << " 相比有 " << regressions << " 项退化" << endl;
+    }
+    if (updateBaseline) {
+        fs::copy_file(output, baseline, fs::copy_options::overwrite_existing);
+        cout << "已用本次结果更新基线 " << baseline << endl;
+    }
+    return regressions == 0 ? 0 : 1;
+}